@@ -1,5 +1,9 @@
 #include "common.h"
 
+#if defined(__ARM_FEATURE_DSP) && __ARM_FEATURE_DSP
+#include <cmsis_core.h>
+#endif
+
 //
 // https://github.com/rygorous/gaffer_net/blob/master/main.cpp
 // https://go-compression.github.io/algorithms/arithmetic/
@@ -19,57 +23,377 @@
 // TODO:
 // + compression, easiest would be just using a hardcoded huffman table, also try rans, delta
 // massaging
-// + buffer channels to create larger packets, reducing header overhead and improving compression
-// + for extra packet security we could store a 16 bit sequence number and ensure as we drop, we drop every packet
-// + could also do a simple checksum on packets
 //
 
 LOG_MODULE_REGISTER(channel);
 // LOG_MODULE_REGISTER(channel, LOG_LEVEL_DBG);
 
+//
+// Packets are 2 byte aligned records behind a 2 byte ring header. A data packet holds one FIFO
+// read: a varint (LEB128) millisecond delta from the previous packet's timestamp, then one
+// section per channel, byte packed back to back. A section header is 4 bytes: channel, quant and
+// codec in the first byte, then an 11 bit length, the predictor, a flag saying a 16 bit rate
+// follows and a 10 bit sample count. The rate is only sent when it changes, or for the first
+// section of each channel a writer puts after an anchor.
+//
+// Anchors carry the format version and the absolute timestamp. One is written every
+// CHANNEL_ANCHOR_INTERVAL ms and at least CHANNEL_ANCHORS_PER_BUFFER times per trip around the
+// ring, so a reader can start decoding at any anchor and eviction can only leave a short run of
+// packets at the front of the buffer that has none.
+//
+// Producers don't hold a lock while encoding. channel_start_packet() reserves worst case space
+// at write_pos under packet_lock, the producer fills it through its own channel_writer, and
+// channel_finish_packet() commits it, handing unused space back or covering it with a padding
+// packet. A reservation is only an address range: the writer claims it CHANNEL_CLAIM_LEN bytes at
+// a time as the packet grows, evicting only as much as it really takes, and a packet reserved
+// later claims everything before it. Packets can commit out of order, so readers only see packets
+// up to commit_pos, the first one still being written, and eviction stops there too.
+//
+// Packets run on across the end of the buffer. What goes past the end is written into the
+// mirror behind it and copied to the front once the packet is done, so every packet can still be
+// read in one piece from where it starts. A packet that might run further than the mirror holds
+// starts at the front instead, behind a padding packet.
+//
+// Readers copy what they need under packet_lock one packet at a time. Positions are reused, so
+// every packet also has a sequence number (counted, not stored); a reader whose packet has been
+// evicted in the meantime starts over at the oldest packet.
+//
+// Eviction is charged to every channel_reader that hadn't read the packet yet, per channel, and
+// the reader hands that on as a gap record ahead of the data that follows: for each channel the
+// timestamps of the first and last packet it lost and how many samples they held. Gap records are
+// only made by readers, the ring itself never holds one.
+//
+// Eviction goes for bulk channels first. Every channel has a retention class, and when room is
+// needed with an anchor at the front, the oldest span (an anchor and the packets up to the next
+// one) that still holds bulk sections is thinned instead of dropped: its bulk sections are cut
+// out, and everything from read_pos on is moved up against the next anchor, which frees the space
+// at the front. Thinned spans collect at the front of the ring until they would take more than
+// keep_share percent of it; from then on the oldest packets are dropped as before. Cut sections
+// count as evicted, and a reader part way through the span moves on to its end. Thinning reads
+// and moves a lot more than dropping, so it runs with packet_lock released; writers that need
+// room wait for it, and so do readers that haven't got past the span.
+//
+enum packet_type {
+	PACKET_DATA,
+	PACKET_PADDING,
+	PACKET_ANCHOR,
+	PACKET_GAP,
+};
+
 struct packet_header {
-	uint16_t timestamp;
-	enum channel channel;
-	enum quantize quant;
-	uint16_t rate;
-	uint16_t len;
+	uint16_t len: 13;
+	uint16_t committed: 1;
+	uint16_t type: 2;
 	uint8_t data[];
 };
 
+struct packet_section {
+	uint8_t channel: 3;
+	uint8_t quant: 3;
+	uint8_t codec: 2;
+	uint32_t len: 11;
+	uint32_t pred: 2;
+	uint32_t has_config: 1;
+	uint32_t samples: 10;
+} __packed;
+
+// A section with has_config set is followed by its sample rate (LE u16) and, for raw sections,
+// the size of one sensor code in the channel's units (LE float32).
+#define CHANNEL_FORMAT_VERSION     4
+#define CHANNEL_ANCHOR_INTERVAL    10000 // ms
+#define CHANNEL_ANCHORS_PER_BUFFER 8
+
+#define PACKET_ALIGN        2
+#define PACKET_WRAP_LEN     512 // a full LIS3DH FIFO, worst case
+#define PACKET_MAX_LEN      4096
+#define PACKET_MAX_SECTIONS CHANNEL_COUNT
+#define SECTION_MAX_LEN     1024
+#define SECTION_MAX_SAMPLES 1023
+#define SAMPLE_MAX_LEN      4 // a Rice escape
+#define SECTION_RATE_LEN    2
+#define SECTION_SCALE_LEN   4
+#define SECTION_CONFIG_LEN  (SECTION_RATE_LEN + SECTION_SCALE_LEN)
+#define VARINT_MAX_LEN      10
+#define CHANNEL_BATCH_LEN   32
+#define CHANNEL_CLAIM_LEN   64
+
+#define PACKET_ALIGN_UP(x) (((x) + PACKET_ALIGN - 1) & ~(PACKET_ALIGN - 1))
+
+// A gap record holds a channel byte, two timestamps and a sample count for each channel.
+#define GAP_ENTRY_MAX_LEN  (1 + 2 * VARINT_MAX_LEN + 5)
+#define GAP_RECORD_MAX_LEN                                                                         \
+	PACKET_ALIGN_UP(sizeof(struct packet_header) + CHANNEL_COUNT * GAP_ENTRY_MAX_LEN)
+
+#define CHANNEL_MAX_READERS 4
+
 #define PACKET_BUFFER_SIZE 32768
-uint8_t packet_buffer[PACKET_BUFFER_SIZE];
+uint8_t packet_buffer[PACKET_BUFFER_SIZE + PACKET_WRAP_LEN];
 uint32_t buffer_size = PACKET_BUFFER_SIZE;
 uint32_t write_pos;
 uint32_t read_pos;
-uint32_t wrap_pos = PACKET_BUFFER_SIZE;
-int32_t last_sample;
+uint32_t commit_pos;
+uint32_t first_seq;
+uint32_t commit_seq;
+uint32_t next_seq;
+uint32_t reserve_failures;
+uint32_t buffer_high_water;
+
+struct channel_reader *channel_readers[CHANNEL_MAX_READERS];
+uint8_t channel_reader_count;
+
+struct k_spinlock packet_lock;
+
+//
+// Rice codec: the first sample is stored as 16 raw bits, then each residual is zigzagged and
+// Rice coded with a k that tracks a running mean of recent residuals (as in LOCO-I), so no k
+// needs to be sent. Runs of RICE_LIMIT ones escape to a raw 17 bit residual, which keeps the
+// worst case at 32 bits per sample. The final byte is padded with ones, which the decoder sees
+// as a truncated unary prefix.
+//
+#define RICE_LIMIT        15
+#define RICE_ESCAPE_BITS  17
+#define RICE_MEAN_SHIFT   4
+#define RICE_INITIAL_MEAN 4
+
+enum codec channel_codec = CODEC_DELTA8;
+
+struct codec_stats {
+	uint32_t packets;
+	uint32_t samples;
+	uint32_t bytes;
+};
+
+struct codec_stats codec_stats[CODEC_COUNT];
+uint32_t header_bytes;
+
+//
+// Per channel counters, kept up to date as sections are finished and dropped so status never has
+// to walk the ring. Written counters only go up; retained ones follow what is in the ring. The
+// rate window holds one bucket per second; the current bucket is still filling, so rates are
+// taken over the other CHANNEL_RATE_WINDOW - 1.
+//
+#define CHANNEL_RATE_WINDOW 5
+
+struct channel_stats {
+	uint32_t packets;
+	uint32_t samples;
+	uint64_t encoded_bits;
+	int32_t residual_min;
+	int32_t residual_max;
+	uint32_t retained_packets;
+	uint32_t retained_bytes;
+	uint32_t dropped_packets;
+	uint32_t dropped_bytes;
+	uint32_t dropped_samples;
+	uint64_t retained_since;
+	uint32_t window_second;
+	uint32_t window_samples[CHANNEL_RATE_WINDOW];
+	uint32_t window_bits[CHANNEL_RATE_WINDOW];
+};
+
+struct channel_stats channel_stats[CHANNEL_COUNT];
 
 uint64_t first_timestamp;
 uint64_t last_timestamp;
+uint64_t anchor_timestamp;
+uint32_t anchor_count;
+uint32_t anchor_bytes;
+bool anchor_due = true;
+
+enum retention {
+	RETENTION_BULK,
+	RETENTION_KEEP,
+	RETENTION_COUNT
+};
 
-K_MUTEX_DEFINE(packet_mutex);
+const char *retention_names[] = {"bulk", "keep"};
+// Temperature and pressure change slowly and take little room, and are what tire analysis wants
+// the longest history of.
+uint8_t channel_retention[CHANNEL_COUNT] = {
+	[CHANNEL_TEMPERATURE] = RETENTION_KEEP,
+	[CHANNEL_PRESSURE] = RETENTION_KEEP,
+};
+uint8_t keep_share = 25;
+// Everything from read_pos up to thin_pos has been thinned already; thin_seq is the sequence
+// number at thin_pos.
+uint32_t thin_pos;
+uint32_t thin_seq;
+uint32_t thin_count;
+uint32_t thin_bytes;
+// thin_span() moves packets with packet_lock released, one span at a time under thin_lock. While
+// thin_busy nothing is evicted, and readers before thin_fence wait for thin_lock. thin_failed
+// says the anchor at read_pos can't be thinned, so it is dropped instead.
+K_MUTEX_DEFINE(thin_lock);
+bool thin_busy;
+uint32_t thin_fence;
+bool thin_failed;
 
 const char *channel_names[] = {"null", "accel.x", "accel.y", "accel.z", "temperature", "pressure"};
-const char *quantize_names[] = {"1.0", "0.1", "0.01", "0.001", "0.0001"};
-const float quantize_factors[] = {1.0f, 0.1f, 0.01f, 0.001f, 0.0001f};
+const char *quantize_names[] = {"1.0", "0.1", "0.01", "0.001", "0.0001", "raw"};
+const float quantize_factors[] = {1.0f, 0.1f, 0.01f, 0.001f, 0.0001f, 1.0f};
+const char *codec_names[] = {"delta8", "rans", "rice"};
+const char *predictor_names[] = {"order0", "order1", "order2", "lpc"};
 
-static bool is_valid_packet(struct packet_header *packet)
+static uint8_t varint_len(uint64_t value)
+{
+	uint8_t len = 1;
+	while (value >= 0x80) {
+		value >>= 7;
+		len++;
+	}
+	return len;
+}
+
+static uint8_t put_varint(uint8_t *data, uint64_t value)
+{
+	uint8_t len = 0;
+	while (value >= 0x80) {
+		data[len++] = (value & 0x7f) | 0x80;
+		value >>= 7;
+	}
+	data[len++] = value;
+	return len;
+}
+
+// Returns the number of bytes read, or 0 if the varint runs past len.
+static uint8_t get_varint(const uint8_t *data, uint32_t len, uint64_t *value)
+{
+	*value = 0;
+	for (uint8_t i = 0; i < MIN(len, VARINT_MAX_LEN); i++) {
+		*value |= (uint64_t)(data[i] & 0x7f) << (7 * i);
+		if ((data[i] & 0x80) == 0) {
+			return i + 1;
+		}
+	}
+	return 0;
+}
+
+static uint8_t section_config_len(struct packet_section *section)
+{
+	if (!section->has_config) {
+		return 0;
+	}
+	return SECTION_RATE_LEN + (section->quant == QUANTIZE_RAW ? SECTION_SCALE_LEN : 0);
+}
+
+static uint8_t section_header_len(struct packet_section *section)
+{
+	return sizeof(struct packet_section) + section_config_len(section);
+}
+
+static uint16_t section_rate(struct packet_section *section)
+{
+	uint8_t *rate = (uint8_t *)(section + 1);
+	return rate[0] | (rate[1] << 8);
+}
+
+static float section_scale(struct packet_section *section)
+{
+	uint8_t *data = (uint8_t *)(section + 1) + SECTION_RATE_LEN;
+	uint32_t bits = data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+	float scale;
+
+	memcpy(&scale, &bits, sizeof(scale));
+	return scale;
+}
+
+static uint8_t *section_data(struct packet_section *section)
+{
+	return (uint8_t *)section + section_header_len(section);
+}
+
+static struct packet_section *first_section(struct packet_header *packet)
+{
+	uint64_t delta;
+	uint8_t pos = get_varint(packet->data, packet->len, &delta);
+	return (struct packet_section *)(packet->data + pos);
+}
+
+static struct packet_section *next_section(struct packet_header *packet,
+					   struct packet_section *section)
+{
+	uint8_t *next = section_data(section) + section->len;
+	if (next >= packet->data + packet->len) {
+		return NULL;
+	}
+	return (struct packet_section *)next;
+}
+
+// Data packets carry a delta from the previous packet, anchors an absolute timestamp.
+static uint64_t packet_timestamp(struct packet_header *packet, uint64_t prev)
+{
+	uint64_t value;
+
+	if (packet->type == PACKET_ANCHOR) {
+		get_varint(packet->data + 1, packet->len - 1, &value);
+		return value;
+	}
+	if (packet->type == PACKET_DATA) {
+		get_varint(packet->data, packet->len, &value);
+		return prev + value;
+	}
+	return prev;
+}
+
+static bool is_valid_section(struct packet_section *section)
 {
-	if (packet->channel >= CHANNEL_COUNT) {
+	if (section->channel >= CHANNEL_COUNT) {
+		return false;
+	}
+	if (section->quant >= QUANTIZE_COUNT) {
+		return false;
+	}
+	if (section->codec >= CODEC_COUNT) {
 		return false;
 	}
-	if (packet->quant >= QUANTIZE_COUNT) {
+	if (section->has_config && section_rate(section) == 0) {
 		return false;
 	}
-	if (packet->rate == 0) {
+	if (section->has_config && section->quant == QUANTIZE_RAW &&
+	    !(section_scale(section) > 0.0f)) {
 		return false;
 	}
-	if (packet->len == 0 || packet->len > 1024) {
+	if (section->len > SECTION_MAX_LEN) {
 		return false;
 	}
 	return true;
 }
 
+static bool is_valid_packet(struct packet_header *packet)
+{
+	uint64_t value;
+
+	if (packet->type == PACKET_PADDING) {
+		return true;
+	}
+	if (packet->type == PACKET_ANCHOR) {
+		return packet->len >= 2 && packet->data[0] == CHANNEL_FORMAT_VERSION &&
+		       get_varint(packet->data + 1, packet->len - 1, &value) == packet->len - 1;
+	}
+	if (packet->type != PACKET_DATA || packet->len > PACKET_MAX_LEN) {
+		return false;
+	}
+
+	uint32_t pos = get_varint(packet->data, packet->len, &value);
+	if (pos == 0 || pos == packet->len) {
+		return false;
+	}
+
+	uint8_t sections = 0;
+	while (pos < packet->len) {
+		struct packet_section *section = (struct packet_section *)(packet->data + pos);
+		if (packet->len - pos < sizeof(struct packet_section) ||
+		    packet->len - pos < section_header_len(section)) {
+			return false;
+		}
+		if (!is_valid_section(section) || ++sections > PACKET_MAX_SECTIONS) {
+			return false;
+		}
+		pos += section_header_len(section) + section->len;
+	}
+	return pos == packet->len;
+}
+
 static void check_packet(struct packet_header *packet)
 {
 	if (is_valid_packet(packet)) {
@@ -78,279 +402,1816 @@ static void check_packet(struct packet_header *packet)
 
 	uint32_t pos = (uint8_t *)packet - packet_buffer;
 
-	LOG_ERR("bad packet at %u: channel=%#x quant=%#x rate=%#x len=%#x", pos, packet->channel,
-		packet->quant, packet->rate, packet->len);
+	LOG_ERR("bad packet at %u: type=%u len=%#x", pos, packet->type, packet->len);
 
 	k_oops();
 }
 
+// Packets still being written are only checked for position; their len is the reservation.
 static struct packet_header *packet_at(uint32_t pos)
 {
-	if (pos >= wrap_pos) {
-		LOG_ERR("bad packet position: %u (wrap at %u)", pos, wrap_pos);
+	if (pos >= buffer_size || (pos % PACKET_ALIGN) != 0) {
+		LOG_ERR("bad packet position: %u (buffer size %u)", pos, buffer_size);
 		k_oops();
 	}
 	struct packet_header *packet = (struct packet_header *)(packet_buffer + pos);
-	check_packet(packet);
+	if (packet->committed) {
+		check_packet(packet);
+	}
 	return packet;
 }
 
-static struct packet_header *first_packet()
+static uint32_t next_packet_pos(uint32_t pos)
 {
-	if (read_pos == write_pos) {
-		return NULL;
+	struct packet_header *packet = packet_at(pos);
+	pos = PACKET_ALIGN_UP(pos + sizeof(struct packet_header) + packet->len);
+	if (pos >= buffer_size) {
+		pos -= buffer_size;
 	}
-	return packet_at(read_pos);
+	return pos;
 }
 
-static struct packet_header *next_packet(struct packet_header *packet)
+static void publish_packets()
 {
-	check_packet(packet);
-	uint32_t pos = (uint8_t *)packet - packet_buffer;
-	pos += sizeof(struct packet_header) + packet->len;
-	pos = (pos + 3) & ~3; // align to 4 bytes
-	if (pos == wrap_pos) {
-		pos = 0;
-	}
-	if (pos == write_pos) {
-		return NULL;
+	while (commit_seq != next_seq) {
+		struct packet_header *packet = (struct packet_header *)(packet_buffer + commit_pos);
+		if (!packet->committed) {
+			break;
+		}
+		commit_pos = next_packet_pos(commit_pos);
+		commit_seq++;
 	}
-	return packet_at(pos);
 }
 
-static void drop_packet()
+static void put_padding(uint32_t pos, uint32_t size)
 {
-	struct packet_header *packet = packet_at(read_pos);
-
-	LOG_DBG("dropping packet %s len=%d at %u", channel_names[packet->channel], packet->len,
-		read_pos);
+	struct packet_header *packet = (struct packet_header *)(packet_buffer + pos);
 
-	first_timestamp += packet->timestamp;
+	packet->len = size - sizeof(struct packet_header);
+	packet->type = PACKET_PADDING;
+	packet->committed = 1;
 
-	read_pos += sizeof(struct packet_header) + packet->len;
-	read_pos = (read_pos + 3) & ~3; // align to 4 bytes
+	next_seq++;
+	publish_packets();
+}
 
-	if (read_pos == wrap_pos) {
-		read_pos = 0;
+// Clears the buckets of the seconds that went by since the last update.
+static void advance_rate_window(struct channel_stats *stats, uint32_t second)
+{
+	uint32_t elapsed = MIN(second - stats->window_second, CHANNEL_RATE_WINDOW);
+	for (uint32_t i = 1; i <= elapsed; i++) {
+		uint32_t bucket = (stats->window_second + i) % CHANNEL_RATE_WINDOW;
+		stats->window_samples[bucket] = 0;
+		stats->window_bits[bucket] = 0;
 	}
+	stats->window_second = second;
 }
 
-bool channel_start_packet(enum channel ch, enum quantize quant, uint64_t ts, uint16_t rate,
-			  uint16_t sample_count)
+// ts is the timestamp of the section's packet; what is left of the channel is newer.
+static void count_dropped_section(struct packet_section *section, uint64_t ts)
 {
-	k_mutex_lock(&packet_mutex, K_FOREVER);
-
-	uint32_t reserve_size = sizeof(struct packet_header) + sample_count * 4; // worst case size
-	reserve_size = (reserve_size + 3) & ~3;                                  // align to 4 bytes
-
-	LOG_DBG("reserve packet channel=%s samples=%d reserve_size=%u write_pos=%u read_pos=%u "
-		"wrap_pos=%u",
-		channel_names[ch], sample_count, reserve_size, write_pos, read_pos, wrap_pos);
+	struct channel_stats *stats = &channel_stats[section->channel];
+
+	stats->retained_packets--;
+	stats->retained_bytes -= section->len;
+	stats->dropped_packets++;
+	stats->dropped_bytes += section->len;
+	stats->dropped_samples += section->samples;
+	stats->retained_since = ts;
+}
 
-	if (write_pos + reserve_size > buffer_size) {
-		LOG_DBG("wrapping packet buffer at %u", write_pos);
+static void count_dropped_sections(struct packet_header *packet, uint64_t ts)
+{
+	for (struct packet_section *section = first_section(packet); section != NULL;
+	     section = next_section(packet, section)) {
+		count_dropped_section(section, ts);
+	}
+}
 
-		if (read_pos > write_pos) {
-			while (read_pos != 0) {
-				drop_packet();
-			}
-            drop_packet();
-        }
+// Charges a section of a packet with timestamp ts to the reader's pending gap record.
+static void add_gap_section(struct channel_reader *r, struct packet_section *section, uint64_t ts)
+{
+	struct channel_gap *gap = &r->gap[section->channel];
 
-		wrap_pos = write_pos;
-		write_pos = 0;
+	if (!(r->gap_channels & BIT(section->channel))) {
+		r->gap_channels |= BIT(section->channel);
+		gap->start = ts;
+		gap->samples = 0;
 	}
+	gap->end = ts;
+	gap->samples += section->samples;
+}
 
-    while (read_pos > write_pos && read_pos < write_pos + reserve_size) {
-        drop_packet();
-    }
-
-	LOG_DBG("new packet channel=%s samples=%d at %u", channel_names[ch], sample_count,
-		write_pos);
+static void add_gap(struct channel_reader *r, struct packet_header *packet, uint64_t ts)
+{
+	for (struct packet_section *section = first_section(packet); section != NULL;
+	     section = next_section(packet, section)) {
+		add_gap_section(r, section, ts);
+	}
+}
 
-	memset(packet_buffer + write_pos, 0, reserve_size);
+static void drop_packet()
+{
+	struct packet_header *packet = packet_at(read_pos);
 
-	struct packet_header *packet = (struct packet_header *)(packet_buffer + write_pos);
+	LOG_DBG("dropping packet type=%u len=%d at %u", packet->type, packet->len, read_pos);
 
-	packet->timestamp = ts - last_timestamp;
-	packet->channel = ch;
-	packet->quant = quant;
-	packet->rate = rate;
-	packet->len = 0;
+	first_timestamp = packet_timestamp(packet, first_timestamp);
 
-	last_timestamp = ts;
-	last_sample = 0;
+	if (packet->type == PACKET_DATA) {
+		count_dropped_sections(packet, first_timestamp);
+		for (int i = 0; i < channel_reader_count; i++) {
+			struct channel_reader *r = channel_readers[i];
+			if ((int32_t)(r->seq - first_seq) <= 0) {
+				add_gap(r, packet, first_timestamp);
+			}
+		}
+	}
 
-	return true;
+	read_pos = next_packet_pos(read_pos);
+	first_seq++;
+	thin_failed = false;
 }
 
-void channel_add_packet_sample(float s)
+static bool ring_empty()
 {
-	struct packet_header *packet = (struct packet_header *)(packet_buffer + write_pos);
-
-	float sq = s * quantize_factors[packet->quant];
-	float t = (sq >= 0.0f) ? 0.5f : -0.5f;
-	int32_t si = (int32_t)(sq + t);
-	int32_t d = si - last_sample;
+	return first_seq == next_seq;
+}
 
-	if (d >= 127 || d < -128) {
-		uint32_t us = (uint32_t)(si + 32768); // make unsigned for transmission
-		packet->data[packet->len++] = 0xff;
-		packet->data[packet->len++] = (us >> 8) & 0xff;
-		packet->data[packet->len++] = us & 0xff;
-	} else {
-		packet->data[packet->len++] = (uint8_t)(d + 128);
+// Bytes from read_pos up to commit_pos.
+static uint32_t committed_bytes()
+{
+	if (first_seq == commit_seq) {
+		return 0;
 	}
-
-	last_sample = si;
+	return (commit_pos + buffer_size - read_pos - 1) % buffer_size + 1;
 }
 
-void channel_finish_packet()
+// Bytes reserved from commit_pos up to write_pos, whether claimed yet or not.
+static uint32_t reserved_bytes()
 {
-	struct packet_header *packet = (struct packet_header *)(packet_buffer + write_pos);
+	return (write_pos + buffer_size - commit_pos) % buffer_size;
+}
 
-	LOG_DBG("finishing packet channel=%s len=%d at %u", channel_names[packet->channel],
-		packet->len, write_pos);
+static uint32_t buffer_used()
+{
+	return MIN(committed_bytes() + reserved_bytes(), buffer_size);
+}
 
-	write_pos += sizeof(struct packet_header) + packet->len;
-	write_pos = (write_pos + 3) & ~3; // align to 4 bytes
+// Copies len bytes from ring position src to dst in pieces that don't cross the end of the
+// buffer, back to front when moving data up, so overlapping moves work either way.
+static void ring_move(uint32_t dst, uint32_t src, uint32_t len, bool up)
+{
+	while (len > 0) {
+		uint32_t n;
+
+		if (up) {
+			uint32_t dst_end = (dst + len - 1) % buffer_size + 1;
+			uint32_t src_end = (src + len - 1) % buffer_size + 1;
+			n = MIN(len, MIN(dst_end, src_end));
+			memmove(packet_buffer + dst_end - n, packet_buffer + src_end - n, n);
+		} else {
+			n = MIN(len, MIN(buffer_size - dst, buffer_size - src));
+			memmove(packet_buffer + dst, packet_buffer + src, n);
+			dst = (dst + n) % buffer_size;
+			src = (src + n) % buffer_size;
+		}
+		len -= n;
+	}
+}
 
-	LOG_DBG("new write_packet at %u", write_pos);
+static void ring_write(uint32_t dst, const uint8_t *data, uint32_t len)
+{
+	uint32_t n = MIN(len, buffer_size - dst);
 
-	k_mutex_unlock(&packet_mutex);
+	memcpy(packet_buffer + dst, data, n);
+	memcpy(packet_buffer, data + n, len - n);
 }
 
-uint64_t channel_timestamp()
+static bool is_kept(struct packet_section *section)
 {
-	return k_uptime_get_32();
+	return channel_retention[section->channel] == RETENTION_KEEP;
 }
 
-static int cmd_channel_buffer_size(const struct shell *shell, size_t argc, char *argv[])
+// Cuts the bulk sections out of the data packet at src, adding carry (the deltas of the packets
+// before it that were cut out entirely) to its delta. Returns its size after, 0 if nothing is
+// left, and if write is set puts what is left at dst. dst is never past src, and the header can
+// only grow into space freed before it, so every piece moves front to back.
+static uint32_t thin_packet(uint32_t src, uint32_t dst, uint64_t *carry, bool write)
 {
-	uint32_t new_size = strtoul(argv[1], NULL, 0);
-	if (new_size < 256 || new_size > PACKET_BUFFER_SIZE) {
-		shell_fprintf(shell, SHELL_ERROR, "invalid buffer size: %u (min 256 max %u)\n",
-			      new_size, PACKET_BUFFER_SIZE);
-		return -1;
+	struct packet_header *packet = packet_at(src);
+	uint8_t head[sizeof(struct packet_header) + VARINT_MAX_LEN];
+	struct packet_header *header = (struct packet_header *)head;
+	uint16_t offsets[PACKET_MAX_SECTIONS];
+	uint16_t lens[PACKET_MAX_SECTIONS];
+	uint8_t count = 0;
+	uint32_t kept = 0;
+	uint64_t delta;
+
+	get_varint(packet->data, packet->len, &delta);
+
+	for (struct packet_section *section = first_section(packet); section != NULL;
+	     section = next_section(packet, section)) {
+		if (is_kept(section)) {
+			offsets[count] = (uint8_t *)section - (uint8_t *)packet;
+			lens[count] = section_header_len(section) + section->len;
+			kept += lens[count++];
+		}
 	}
 
-	k_mutex_lock(&packet_mutex, K_FOREVER);
-	buffer_size = new_size;
-	write_pos = 0;
-	read_pos = 0;
-	wrap_pos = buffer_size;
-	k_mutex_unlock(&packet_mutex);
+	if (count == 0) {
+		*carry += delta;
+		return 0;
+	}
 
-	shell_fprintf(shell, SHELL_NORMAL, "channel buffer size is now %u\n", buffer_size);
-	return 0;
+	uint32_t len = put_varint(header->data, delta + *carry) + kept;
+	uint32_t size = PACKET_ALIGN_UP(sizeof(struct packet_header) + len);
+	uint32_t pos = (dst + sizeof(struct packet_header) + len - kept) % buffer_size;
+
+	*carry = 0;
+	if (!write) {
+		return size;
+	}
+
+	header->len = len;
+	header->type = PACKET_DATA;
+	header->committed = 1;
+	ring_write(dst, head, sizeof(struct packet_header) + len - kept);
+
+	for (uint8_t i = 0; i < count; i++) {
+		ring_move(pos, (src + offsets[i]) % buffer_size, lens[i], false);
+		pos = (pos + lens[i]) % buffer_size;
+	}
+	if (size > sizeof(struct packet_header) + len) {
+		packet_buffer[pos] = 0;
+	}
+	return size;
 }
 
-static int cmd_channel_log(const struct shell *shell, size_t argc, char *argv[])
+// Charges the sections thin_packet() is about to cut from the packet at pos, with timestamp ts
+// and sequence number seq, to the stats and to every reader that hasn't read it. Readers inside
+// the span lose all of it, they are moved on to its end.
+static void count_thinned_sections(uint32_t pos, uint32_t seq, uint64_t ts)
 {
-	k_mutex_lock(&packet_mutex, K_FOREVER);
+	struct packet_header *packet = packet_at(pos);
+
+	if (packet->type != PACKET_DATA) {
+		return;
+	}
 
-	uint64_t timestamp = first_timestamp;
+	for (int i = 0; i < channel_reader_count; i++) {
+		struct channel_reader *r = channel_readers[i];
+		bool inside = (int32_t)(r->seq - thin_seq) > 0;
 
-	for (struct packet_header *packet = first_packet(); packet != NULL;
-	     packet = next_packet(packet)) {
-		timestamp += packet->timestamp;
-		shell_fprintf(shell, SHELL_NORMAL, "ts=%llu ch=%s quant=%s rate=%u len=%u\n",
-			      timestamp, channel_names[packet->channel],
-			      quantize_names[packet->quant], packet->rate, packet->len);
+		if ((int32_t)(r->seq - seq) > 0) {
+			continue;
+		}
+		if (inside) {
+			r->lost++;
+		}
+		for (struct packet_section *section = first_section(packet); section != NULL;
+		     section = next_section(packet, section)) {
+			if (inside || !is_kept(section)) {
+				add_gap_section(r, section, ts);
+			}
+		}
 	}
 
-	k_mutex_unlock(&packet_mutex);
-	return 0;
+	for (struct packet_section *section = first_section(packet); section != NULL;
+	     section = next_section(packet, section)) {
+		if (!is_kept(section)) {
+			count_dropped_section(section, ts);
+		}
+	}
 }
 
-static int cmd_channel_status(const struct shell *shell, size_t argc, char *argv[])
+// Thins the oldest span before stop_seq that still has bulk sections, see the top of the file.
+// Returns false if there is none, or if the thinned spans would take more than keep_share of the
+// buffer. Called with thin_busy set, so only this touches the ring up to stop_seq; packet_lock
+// is only taken to charge what is cut and to move read_pos, first_seq and the readers.
+static bool thin_span(uint32_t stop_seq)
 {
-	k_mutex_lock(&packet_mutex, K_FOREVER);
+	uint32_t budget = buffer_size / 100 * keep_share;
+	uint32_t thinned;
+	uint32_t span_end;
+	uint32_t end_seq;
+	uint32_t span;
+	uint32_t size;
+	uint64_t carry;
+
+	if ((int32_t)(thin_seq - first_seq) <= 0) {
+		thin_pos = read_pos;
+		thin_seq = first_seq;
+	}
+	thinned = (thin_pos + buffer_size - read_pos) % buffer_size;
 
-	uint32_t time_window = channel_timestamp() - first_timestamp;
+	// Find the span and its size once thinned, skipping spans with nothing to cut.
+	for (;;) {
+		if (thin_seq == stop_seq || packet_at(thin_pos)->type != PACKET_ANCHOR) {
+			return false;
+		}
 
-	uint32_t buffer_used;
-	if (read_pos > write_pos) {
-		buffer_used = (wrap_pos - read_pos) + write_pos;
-	} else {
-		buffer_used = write_pos - read_pos;
+		span_end = next_packet_pos(thin_pos);
+		end_seq = thin_seq + 1;
+		span = (span_end + buffer_size - thin_pos) % buffer_size;
+		size = span;
+		carry = 0;
+
+		while (end_seq != stop_seq && packet_at(span_end)->type != PACKET_ANCHOR) {
+			struct packet_header *packet = packet_at(span_end);
+			uint32_t len = PACKET_ALIGN_UP(sizeof(struct packet_header) + packet->len);
+			uint32_t thin = packet->type == PACKET_DATA
+						? thin_packet(span_end, 0, &carry, false)
+						: 0;
+
+			// Moved up, any packet could end up running across the end of the buffer.
+			if (thin > PACKET_WRAP_LEN) {
+				return false;
+			}
+			span += len;
+			size += thin;
+			span_end = next_packet_pos(span_end);
+			end_seq++;
+		}
+
+		if (end_seq == stop_seq || thinned + size > budget) {
+			return false;
+		}
+		if (size < span) {
+			break;
+		}
+		thinned += span;
+		thin_pos = span_end;
+		thin_seq = end_seq;
 	}
 
-	shell_fprintf(shell, SHELL_NORMAL, "buffer status:\n");
-	shell_fprintf(shell, SHELL_NORMAL, " buffer_size: %u\n", buffer_size);
-	shell_fprintf(shell, SHELL_NORMAL, " buffer_used: %u\n", buffer_used);
-	shell_fprintf(shell, SHELL_NORMAL, " time_window: %u\n", time_window);
+	LOG_DBG("thinning span at %u: %u of %u bytes left", thin_pos, size, span);
+
+	k_spinlock_key_t key = k_spin_lock(&packet_lock);
+	thin_fence = end_seq;
+	k_spin_unlock(&packet_lock, key);
+
+	// Pack the thinned span down to thin_pos, then move it all up against the next anchor.
+	struct packet_header *anchor = packet_at(thin_pos);
+	uint64_t ts = packet_timestamp(anchor, 0);
+	uint32_t src = next_packet_pos(thin_pos);
+	uint32_t dst = (thin_pos + PACKET_ALIGN_UP(sizeof(struct packet_header) + anchor->len)) %
+		       buffer_size;
+	uint32_t removed = 0;
+
+	carry = 0;
+	for (uint32_t seq = thin_seq + 1; seq != end_seq; seq++) {
+		struct packet_header *packet = packet_at(src);
+		uint32_t next = next_packet_pos(src);
+		uint32_t thin = 0;
+
+		ts = packet_timestamp(packet, ts);
+		key = k_spin_lock(&packet_lock);
+		count_thinned_sections(src, seq, ts);
+		k_spin_unlock(&packet_lock, key);
+		if (packet->type == PACKET_DATA) {
+			thin = thin_packet(src, dst, &carry, true);
+		}
+		removed += thin == 0;
+		dst = (dst + thin) % buffer_size;
+		src = next;
+	}
 
-	shell_fprintf(shell, SHELL_NORMAL, "channel status:\n");
-	for (int ch = 0; ch < CHANNEL_COUNT; ch++) {
-		uint32_t packet_count = 0;
-		uint32_t byte_count = 0;
-		for (struct packet_header *packet = first_packet(); packet != NULL;
-		     packet = next_packet(packet)) {
-			if (packet->channel == ch) {
-				packet_count++;
-				byte_count += packet->len;
+	uint32_t freed = span - size;
+	uint32_t block = thinned + size;
+
+	uint32_t start = (read_pos + freed) % buffer_size;
+
+	ring_move(start, read_pos, block, true);
+
+	// The packet now running across the end of the buffer, if any, needs its mirror.
+	if (start + block > buffer_size) {
+		memcpy(packet_buffer + buffer_size, packet_buffer,
+		       MIN(start + block - buffer_size, PACKET_WRAP_LEN));
+	}
+
+	key = k_spin_lock(&packet_lock);
+
+	for (int i = 0; i < channel_reader_count; i++) {
+		struct channel_reader *r = channel_readers[i];
+
+		if ((int32_t)(r->seq - thin_seq) > 0 && (int32_t)(r->seq - end_seq) < 0) {
+			r->pos = span_end;
+			r->seq = end_seq;
+			r->timestamp = packet_timestamp(packet_at(span_end), 0);
+			r->resync = false;
+		} else if ((int32_t)(r->seq - thin_seq) <= 0) {
+			if ((int32_t)(r->seq - first_seq) >= 0) {
+				r->pos = (r->pos + freed) % buffer_size;
 			}
+			r->seq += removed;
 		}
-		float packets_per_sec =
-			(time_window > 0) ? (packet_count * 1000.0f / time_window) : 0.0f;
-		float bytes_per_sec =
-			(time_window > 0) ? (byte_count * 1000.0f / time_window) : 0.0f;
-		shell_fprintf(shell, SHELL_NORMAL,
-			      " %s: packets=%u bytes=%u packets/sec=%.2f bytes/sec=%.2f\n",
-			      channel_names[ch], packet_count, byte_count, (double)packets_per_sec,
-			      (double)bytes_per_sec);
 	}
 
-	k_mutex_unlock(&packet_mutex);
-	return 0;
+	read_pos = start;
+	first_seq += removed;
+	thin_pos = span_end;
+	thin_seq = end_seq;
+	thin_count++;
+	thin_bytes += freed;
+
+	k_spin_unlock(&packet_lock, key);
+	return true;
 }
 
-static void channel_test_thread_main(void *, void *, void *)
+enum room {
+	ROOM_MADE,
+	ROOM_THIN, // the anchor at read_pos wants its span thinned first
+	ROOM_WAIT, // a span is being thinned
+};
+
+// Evicts the oldest packets until size bytes from commit_pos on are free. Packets still being
+// written are never evicted; channel_start_packet() keeps every reservation short enough that
+// they don't have to be. Spans are thinned before they are dropped, but not under packet_lock:
+// when one is due this stops, and the caller hands the result to wait_for_room() and tries
+// again.
+static enum room make_room(uint32_t size)
 {
-	for (;;) {
-        uint64_t timestamp = channel_timestamp();
-        uint32_t count = sys_rand32_get() % 100 + 1;
-        uint32_t samples_per_sec = 999;
-        if (channel_start_packet(CHANNEL_NULL, QUANTIZE_1_0, timestamp,
-                samples_per_sec, count)) {
-            for (int i = 0; i < count; i++) {
-                channel_add_packet_sample(i);
-            }
-            channel_finish_packet();
-        }
+	while (first_seq != commit_seq && committed_bytes() + size > buffer_size) {
+		if (thin_busy) {
+			return ROOM_WAIT;
+		}
+		if (packet_at(read_pos)->type == PACKET_ANCHOR && !thin_failed) {
+			return ROOM_THIN;
+		}
+		drop_packet();
+	}
+	return ROOM_MADE;
+}
+
+// Thins the span make_room() asked for, unless someone else got to it first, or waits for the
+// one being thinned. Drops packet_lock meanwhile, so whatever the caller worked out under it is
+// stale.
+static k_spinlock_key_t wait_for_room(k_spinlock_key_t key, enum room room)
+{
+	uint32_t seq = first_seq;
+	uint32_t thins = thin_count;
+
+	k_spin_unlock(&packet_lock, key);
+	k_mutex_lock(&thin_lock, K_FOREVER);
+	key = k_spin_lock(&packet_lock);
+
+	if (room == ROOM_THIN && first_seq == seq && thin_count == thins) {
+		uint32_t stop_seq = commit_seq;
 
-        k_msleep(sys_rand32_get() % 100 + 1);
+		thin_busy = true;
+		thin_fence = first_seq;
+		k_spin_unlock(&packet_lock, key);
+
+		bool thinned = thin_span(stop_seq);
+
+		key = k_spin_lock(&packet_lock);
+		thin_failed = !thinned;
+		thin_busy = false;
 	}
+
+	k_spin_unlock(&packet_lock, key);
+	k_mutex_unlock(&thin_lock);
+	return k_spin_lock(&packet_lock);
 }
 
-K_THREAD_STACK_DEFINE(channel_test_thread_stack, 256);
-struct k_thread channel_test_thread;
+// Whether a reader at sequence number seq has to wait for thin_span(), which may be moving
+// the packets it is about to read.
+static bool thin_fenced(uint32_t seq)
+{
+	return thin_busy && (int32_t)(seq - thin_fence) < 0;
+}
 
-static int cmd_channel_start_test(const struct shell *shell, size_t argc, char *argv[])
+// Drops packet_lock until thin_span() is done.
+static k_spinlock_key_t wait_for_thinning(k_spinlock_key_t key)
 {
-    k_thread_create(&channel_test_thread, channel_test_thread_stack,
-        K_THREAD_STACK_SIZEOF(channel_test_thread_stack),
-        channel_test_thread_main,
-        NULL, NULL, NULL,
-        7, 0, K_NO_WAIT);
+	k_spin_unlock(&packet_lock, key);
+	k_mutex_lock(&thin_lock, K_FOREVER);
+	k_mutex_unlock(&thin_lock);
+	return k_spin_lock(&packet_lock);
+}
 
-    shell_fprintf(shell, SHELL_NORMAL, "channel test started\n");
-    return 0;
+// Reserves size bytes at write_pos for the next packet.
+static void advance_write_pos(uint32_t size)
+{
+	write_pos += size;
+	if (write_pos >= buffer_size) {
+		write_pos -= buffer_size;
+	}
+	next_seq++;
 }
 
-static int cmd_channel_stop_test(const struct shell *shell, size_t argc, char *argv[])
+// Copies what the size byte packet at pos ran into the mirror past the end of the buffer to the
+// front.
+static void copy_mirror(uint32_t pos, uint32_t size)
 {
-    k_thread_abort(&channel_test_thread);
+	if (pos + size > buffer_size) {
+		memcpy(packet_buffer, packet_buffer + buffer_size, pos + size - buffer_size);
+	}
+}
 
-    shell_fprintf(shell, SHELL_NORMAL, "channel test stopped\n");
-    return 0;
+// Pads out the end of the buffer, so the next packet starts at the front.
+static void wrap_write_pos()
+{
+	LOG_DBG("wrapping packet buffer at %u", write_pos);
+
+	if (ring_empty()) {
+		read_pos = 0;
+		commit_pos = 0;
+	} else {
+		anchor_bytes += buffer_size - write_pos;
+		put_padding(write_pos, buffer_size - write_pos);
+	}
+	write_pos = 0;
+}
+
+static void put_anchor(uint64_t ts, uint32_t size)
+{
+	struct packet_header *packet = (struct packet_header *)(packet_buffer + write_pos);
+
+	packet->len = 1 + varint_len(ts);
+	packet->type = PACKET_ANCHOR;
+	packet->committed = 1;
+	packet->data[0] = CHANNEL_FORMAT_VERSION;
+	put_varint(packet->data + 1, ts);
+
+	copy_mirror(write_pos, size);
+	advance_write_pos(size);
+	publish_packets();
+
+	header_bytes += size;
+	last_timestamp = ts;
+	anchor_timestamp = ts;
+	anchor_count++;
+	anchor_bytes = 0;
+	anchor_due = false;
+}
+
+bool channel_start_packet(struct channel_writer *w, uint64_t ts, uint8_t section_count,
+			  uint16_t sample_count)
+{
+	uint32_t max_size = sizeof(struct packet_header) + VARINT_MAX_LEN +
+			    section_count * (sizeof(struct packet_section) + SECTION_CONFIG_LEN) +
+			    sample_count * SAMPLE_MAX_LEN; // worst case size
+
+	if (section_count == 0 || section_count > PACKET_MAX_SECTIONS ||
+	    sample_count > SECTION_MAX_SAMPLES ||
+	    max_size > sizeof(struct packet_header) + PACKET_MAX_LEN) {
+		LOG_ERR("bad packet size: sections=%d samples=%d", section_count, sample_count);
+		return false;
+	}
+
+	uint32_t anchor_size;
+	uint64_t delta;
+	uint32_t size;
+	uint32_t pad;
+
+	PERF_START(t);
+	k_spinlock_key_t key = k_spin_lock(&packet_lock);
+
+	// Waiting for room drops packet_lock, so it is all worked out again after.
+	for (;;) {
+		// Timestamps are taken before waiting for the ring, so producers can arrive a
+		// little out of order.
+		ts = MAX(ts, last_timestamp);
+
+		if (anchor_due || ts - anchor_timestamp >= CHANNEL_ANCHOR_INTERVAL ||
+		    anchor_bytes >= buffer_size / CHANNEL_ANCHORS_PER_BUFFER) {
+			anchor_due = true;
+		}
+
+		// The anchor if one is due, then padding out the end of the buffer if the packet
+		// could run further than the mirror holds, then the packet.
+		anchor_size = 0;
+		if (anchor_due) {
+			uint32_t len = 1 + varint_len(ts);
+			anchor_size = PACKET_ALIGN_UP(sizeof(struct packet_header) + len);
+		}
+		delta = anchor_due ? 0 : ts - last_timestamp;
+		w->len = varint_len(delta);
+		size = PACKET_ALIGN_UP(max_size - VARINT_MAX_LEN + w->len);
+
+		uint32_t pos = (write_pos + anchor_size) % buffer_size;
+		pad = pos + size > buffer_size + PACKET_WRAP_LEN ? buffer_size - pos : 0;
+
+		uint32_t reserved = reserved_bytes() + anchor_size + pad;
+
+		// Reservations never run all the way round to commit_pos, so claiming space never
+		// has to evict a packet still being written.
+		if (reserved + size >= buffer_size) {
+			reserve_failures++;
+			k_spin_unlock(&packet_lock, key);
+			PERF_END(PERF_RESERVE, t, 0);
+			LOG_DBG("no room to reserve a packet of up to %u bytes", size);
+			return false;
+		}
+
+		w->claim = sizeof(struct packet_header) + w->len;
+
+		enum room room = make_room(reserved + w->claim);
+		if (room == ROOM_MADE) {
+			break;
+		}
+		key = wait_for_room(key, room);
+	}
+
+	if (anchor_size > 0) {
+		put_anchor(ts, anchor_size);
+	}
+	if (pad > 0) {
+		wrap_write_pos();
+	}
+
+	struct packet_header *packet = (struct packet_header *)(packet_buffer + write_pos);
+
+	packet->len = size - sizeof(struct packet_header);
+	packet->type = PACKET_DATA;
+	packet->committed = 0;
+
+	w->pos = write_pos;
+	w->max_size = size;
+	w->anchor = anchor_count;
+	advance_write_pos(size);
+
+	last_timestamp = ts;
+
+	k_spin_unlock(&packet_lock, key);
+
+	LOG_DBG("new packet sections=%d samples=%d max_size=%u at %u", section_count, sample_count,
+		w->max_size, w->pos);
+
+	put_varint(packet->data, delta);
+
+	w->section = NULL;
+	w->sections_left = section_count;
+
+	PERF_END(PERF_RESERVE, t, 0);
+	return true;
+}
+
+// Claims the packet's space up to end bytes from its start, at least CHANNEL_CLAIM_LEN bytes at
+// a time, so eviction only runs every so often. Everything reserved before the packet is
+// claimed along with it.
+static void claim_packet(struct channel_writer *w, uint32_t end)
+{
+	if (end > w->max_size) {
+		LOG_ERR("packet at %u runs past its %u bytes", w->pos, w->max_size);
+		k_oops();
+	}
+
+	uint32_t claim = MIN(MAX(end, w->claim + CHANNEL_CLAIM_LEN), w->max_size);
+
+	k_spinlock_key_t key = k_spin_lock(&packet_lock);
+
+	for (;;) {
+		uint32_t reserved = (w->pos + buffer_size - commit_pos) % buffer_size;
+		enum room room = make_room(reserved + claim);
+
+		if (room == ROOM_MADE) {
+			break;
+		}
+		key = wait_for_room(key, room);
+	}
+	k_spin_unlock(&packet_lock, key);
+
+	w->claim = claim;
+}
+
+// Makes sure the next len bytes of the current section are claimed.
+static inline void claim_section(struct channel_writer *w, uint32_t len)
+{
+	uint32_t end = w->data + w->section_len + len - (packet_buffer + w->pos);
+
+	if (end > w->claim) {
+		claim_packet(w, end);
+	}
+}
+
+// Higher orders fall back to lower ones until the packet has enough history. The prediction is
+// clamped to the 16 bit sample range so residuals always fit the codecs' escape formats.
+static int32_t predict(struct channel_writer *w)
+{
+	int32_t p;
+
+	if (w->samples == 0 || w->pred == PREDICTOR_ORDER0) {
+		p = 0;
+	} else if (w->samples == 1 || w->pred == PREDICTOR_ORDER1) {
+		p = w->last_sample;
+	} else if (w->pred == PREDICTOR_ORDER2) {
+		p = 2 * w->last_sample - w->prev_sample;
+	} else {
+		// half the order2 slope, damps noise
+		p = (3 * w->last_sample - w->prev_sample) >> 1;
+	}
+
+	return CLAMP(p, INT16_MIN, INT16_MAX);
+}
+
+// Appends up to 24 bits, MSB first.
+static void put_bits(struct channel_writer *w, uint32_t value, uint8_t bits)
+{
+	w->bit_acc = (w->bit_acc << bits) | value;
+	w->bit_count += bits;
+	while (w->bit_count >= 8) {
+		w->bit_count -= 8;
+		w->data[w->section_len++] = (uint8_t)(w->bit_acc >> w->bit_count);
+	}
+}
+
+static void put_rice_sample(struct channel_writer *w, int32_t si, int32_t d)
+{
+	if (w->samples == 0) {
+		put_bits(w, (uint16_t)(si + 32768), 16);
+		return;
+	}
+
+	uint32_t u = ((uint32_t)d << 1) ^ (uint32_t)(d >> 31); // zigzag
+
+	uint32_t mean = w->rice_sum >> RICE_MEAN_SHIFT;
+	uint8_t k = mean ? 31 - __builtin_clz(mean) : 0;
+	uint32_t q = u >> k;
+
+	if (q < RICE_LIMIT) {
+		put_bits(w, (1u << (q + 1)) - 2, q + 1);
+		put_bits(w, u & BIT_MASK(k), k);
+	} else {
+		put_bits(w, BIT_MASK(RICE_LIMIT), RICE_LIMIT);
+		put_bits(w, u, RICE_ESCAPE_BITS);
+	}
+
+	w->rice_sum += u - (w->rice_sum >> RICE_MEAN_SHIFT);
+}
+
+static void finish_section(struct channel_writer *w)
+{
+	struct packet_section *section = w->section;
+	uint8_t pad_bits = 0;
+
+	// Rice pads the last byte with ones. rANS re-codes the finished delta8 token stream and
+	// falls back to delta8 when it can't make the section smaller.
+	if (w->codec == CODEC_RICE && w->bit_count > 0) {
+		// Samples claim what they fill, a batch of escapes can leave bits over.
+		claim_section(w, 1);
+		pad_bits = 8 - w->bit_count;
+		put_bits(w, BIT_MASK(pad_bits), pad_bits);
+	} else if (w->codec == CODEC_RANS) {
+		int len = rans_encode(section->channel, w->quant, w->data, w->section_len);
+		if (len > 0) {
+			w->section_len = len;
+		} else {
+			w->codec = CODEC_DELTA8;
+		}
+	}
+
+	section->codec = w->codec;
+	section->len = w->section_len;
+	section->samples = w->samples;
+
+	LOG_DBG("finishing section channel=%s codec=%s len=%d", channel_names[section->channel],
+		codec_names[section->codec], section->len);
+
+	w->len += section_header_len(section) + section->len;
+	w->section = NULL;
+
+	uint32_t bits = w->section_len * 8 - pad_bits;
+	uint32_t second = channel_timestamp() / 1000;
+	uint32_t bucket = second % CHANNEL_RATE_WINDOW;
+	struct channel_stats *stats = &channel_stats[section->channel];
+
+	k_spinlock_key_t key = k_spin_lock(&packet_lock);
+
+	codec_stats[w->codec].packets++;
+	codec_stats[w->codec].samples += w->samples;
+	codec_stats[w->codec].bytes += w->section_len;
+	header_bytes += section_header_len(section);
+
+	if (stats->packets == 0) {
+		stats->residual_min = INT32_MAX;
+		stats->residual_max = INT32_MIN;
+		stats->retained_since = last_timestamp;
+	}
+	stats->packets++;
+	stats->samples += w->samples;
+	stats->encoded_bits += bits;
+	stats->residual_min = MIN(stats->residual_min, w->residual_min);
+	stats->residual_max = MAX(stats->residual_max, w->residual_max);
+	stats->retained_packets++;
+	stats->retained_bytes += w->section_len;
+
+	advance_rate_window(stats, second);
+	stats->window_samples[bucket] += w->samples;
+	stats->window_bits[bucket] += bits;
+
+	k_spin_unlock(&packet_lock, key);
+}
+
+static void start_section(struct channel_writer *w, enum channel ch, enum quantize quant,
+			  enum predictor pred, uint16_t rate, float scale)
+{
+	struct packet_header *packet = (struct packet_header *)(packet_buffer + w->pos);
+	enum codec codec = w->codec_pinned ? w->pinned_codec : channel_codec;
+
+	if (w->section != NULL) {
+		finish_section(w);
+	}
+
+	if (w->sections_left == 0) {
+		LOG_ERR("too many sections in packet at %u", w->pos);
+		k_oops();
+	}
+	w->sections_left--;
+
+	uint32_t end = sizeof(struct packet_header) + w->len + sizeof(struct packet_section) +
+		       SECTION_CONFIG_LEN;
+	if (end > w->claim) {
+		claim_packet(w, end);
+	}
+
+	struct packet_section *section = (struct packet_section *)(packet->data + w->len);
+
+	section->channel = ch;
+	section->quant = quant;
+	section->codec = codec;
+	section->pred = pred;
+	section->len = 0;
+	section->samples = 0;
+	section->has_config = w->rate[ch] != rate || w->scale[ch] != scale ||
+			      w->config_anchor[ch] != w->anchor;
+
+	if (section->has_config) {
+		uint8_t *data = (uint8_t *)(section + 1);
+		data[0] = rate & 0xff;
+		data[1] = rate >> 8;
+		if (quant == QUANTIZE_RAW) {
+			uint32_t bits;
+			memcpy(&bits, &scale, sizeof(bits));
+			for (int i = 0; i < SECTION_SCALE_LEN; i++) {
+				data[SECTION_RATE_LEN + i] = bits >> (8 * i);
+			}
+		}
+		w->rate[ch] = rate;
+		w->scale[ch] = scale;
+		w->config_anchor[ch] = w->anchor;
+	}
+
+	w->section = section;
+	w->data = section_data(section);
+	w->section_len = 0;
+	w->codec = codec;
+	w->quant = quant;
+	w->pred = pred;
+	w->last_sample = 0;
+	w->prev_sample = 0;
+	w->samples = 0;
+	w->bit_count = 0;
+	w->rice_sum = RICE_INITIAL_MEAN << RICE_MEAN_SHIFT;
+	w->residual_min = INT32_MAX;
+	w->residual_max = INT32_MIN;
+}
+
+void channel_start_section(struct channel_writer *w, enum channel ch, enum quantize quant,
+			   enum predictor pred, uint16_t rate)
+{
+	if (quant == QUANTIZE_RAW) {
+		LOG_ERR("raw sections need a scale, channel=%s", channel_names[ch]);
+		k_oops();
+	}
+	start_section(w, ch, quant, pred, rate, 0.0f);
+}
+
+void channel_start_raw_section(struct channel_writer *w, enum channel ch, enum predictor pred,
+			       uint16_t rate, float scale)
+{
+	start_section(w, ch, QUANTIZE_RAW, pred, rate, scale);
+}
+
+static void put_residual(struct channel_writer *w, int32_t si, int32_t d)
+{
+	// The first sample has nothing to predict from, so it isn't a residual.
+	if (w->samples > 0) {
+		w->residual_min = MIN(w->residual_min, d);
+		w->residual_max = MAX(w->residual_max, d);
+	}
+
+	if (w->codec == CODEC_RICE) {
+		put_rice_sample(w, si, d);
+	} else if (d >= 127 || d < -128) {
+		uint32_t us = (uint32_t)(si + 32768); // make unsigned for transmission
+		w->data[w->section_len++] = 0xff;
+		w->data[w->section_len++] = (us >> 8) & 0xff;
+		w->data[w->section_len++] = us & 0xff;
+	} else {
+		w->data[w->section_len++] = (uint8_t)(d + 128);
+	}
+
+	w->samples++;
+}
+
+// Everything past quantization is integer, so raw codes and quantized floats share this path.
+// Samples are clamped to 16 bits, which is all the delta8 escape and the Rice header can carry.
+static void put_sample(struct channel_writer *w, int32_t si)
+{
+	si = CLAMP(si, INT16_MIN, INT16_MAX);
+
+	put_residual(w, si, si - predict(w));
+
+	w->prev_sample = w->last_sample;
+	w->last_sample = si;
+}
+
+// Rounds half away from zero.
+static int32_t quantize_sample(float s, float factor)
+{
+	float sq = s * factor;
+
+	return (int32_t)(sq + ((sq >= 0.0f) ? 0.5f : -0.5f));
+}
+
+int32_t channel_quantize(float s, enum quantize quant)
+{
+	return quantize_sample(s, quantize_factors[quant]);
+}
+
+void channel_add_packet_sample(struct channel_writer *w, float s)
+{
+	claim_section(w, SAMPLE_MAX_LEN);
+	put_sample(w, quantize_sample(s, quantize_factors[w->quant]));
+}
+
+void channel_add_packet_code(struct channel_writer *w, int16_t code)
+{
+	claim_section(w, SAMPLE_MAX_LEN);
+	put_sample(w, code);
+}
+
+// Order0 and order1 residuals of a batch. With the M4 DSP extension QSUB16 does two at a time;
+// it saturates rather than wraps, so a residual too big for 16 bits still takes the escape.
+static void batch_residuals(const int16_t *x, int16_t *d, uint16_t n, int16_t prev, bool order1)
+{
+	uint16_t i = 0;
+
+	if (!order1) {
+		memcpy(d, x, n * sizeof(*x));
+		return;
+	}
+
+#if defined(__ARM_FEATURE_DSP) && __ARM_FEATURE_DSP
+	for (; i + 1 < n; i += 2) {
+		uint32_t cur;
+		memcpy(&cur, &x[i], sizeof(cur));
+		uint32_t diff = __QSUB16(cur, (cur << 16) | (uint16_t)prev);
+		memcpy(&d[i], &diff, sizeof(diff));
+		prev = x[i + 1];
+	}
+#endif
+
+	for (; i < n; i++) {
+		d[i] = CLAMP(x[i] - prev, INT16_MIN, INT16_MAX);
+		prev = x[i];
+	}
+}
+
+// Encodes up to CHANNEL_BATCH_LEN clamped samples. Order2 and LPC predictions depend on the
+// two previous samples and are clamped themselves, so those stay on the per-sample path.
+static void put_samples(struct channel_writer *w, const int16_t *x, uint16_t n)
+{
+	int16_t d[CHANNEL_BATCH_LEN] __aligned(4);
+	bool order1 = w->pred == PREDICTOR_ORDER1;
+
+	if (n == 0) {
+		return;
+	}
+
+	claim_section(w, n * SAMPLE_MAX_LEN);
+
+	if (w->pred != PREDICTOR_ORDER0 && !order1) {
+		for (uint16_t i = 0; i < n; i++) {
+			put_sample(w, x[i]);
+		}
+		return;
+	}
+
+	batch_residuals(x, d, n, w->samples > 0 ? w->last_sample : 0, order1);
+
+	for (uint16_t i = 0; i < n; i++) {
+		int32_t di = d[i];
+
+		if (di == INT16_MIN || di == INT16_MAX) {
+			// Possibly saturated; Rice and the residual stats want the exact value.
+			int32_t p = i > 0 ? x[i - 1] : (w->samples > 0 ? w->last_sample : 0);
+			di = x[i] - (order1 ? p : 0);
+		}
+
+		put_residual(w, x[i], di);
+	}
+
+	w->prev_sample = n > 1 ? x[n - 2] : w->last_sample;
+	w->last_sample = x[n - 1];
+}
+
+void channel_add_packet_samples(struct channel_writer *w, const float *s, uint16_t n,
+				uint16_t stride)
+{
+	int16_t x[CHANNEL_BATCH_LEN] __aligned(4);
+	float factor = quantize_factors[w->quant];
+
+	while (n > 0) {
+		uint16_t count = MIN(n, CHANNEL_BATCH_LEN);
+		PERF_START(t);
+
+		for (uint16_t i = 0; i < count; i++, s += stride) {
+			x[i] = CLAMP(quantize_sample(*s, factor), INT16_MIN, INT16_MAX);
+		}
+		put_samples(w, x, count);
+		PERF_END(PERF_ENCODE, t, count);
+		n -= count;
+	}
+}
+
+void channel_add_packet_scaled(struct channel_writer *w, const int16_t *codes, uint16_t n,
+			       uint16_t stride, float scale)
+{
+	int16_t x[CHANNEL_BATCH_LEN] __aligned(4);
+	float factor = quantize_factors[w->quant];
+
+	while (n > 0) {
+		uint16_t count = MIN(n, CHANNEL_BATCH_LEN);
+		PERF_START(t);
+
+		for (uint16_t i = 0; i < count; i++, codes += stride) {
+			x[i] = CLAMP(quantize_sample(*codes * scale, factor), INT16_MIN, INT16_MAX);
+		}
+		put_samples(w, x, count);
+		PERF_END(PERF_ENCODE, t, count);
+		n -= count;
+	}
+}
+
+void channel_add_packet_codes(struct channel_writer *w, const int16_t *codes, uint16_t n,
+			      uint16_t stride, uint8_t shift)
+{
+	int16_t x[CHANNEL_BATCH_LEN] __aligned(4);
+
+	while (n > 0) {
+		uint16_t count = MIN(n, CHANNEL_BATCH_LEN);
+		PERF_START(t);
+
+		for (uint16_t i = 0; i < count; i++, codes += stride) {
+			x[i] = *codes >> shift;
+		}
+		put_samples(w, x, count);
+		PERF_END(PERF_ENCODE, t, count);
+		n -= count;
+	}
+}
+
+void channel_finish_packet(struct channel_writer *w)
+{
+	struct packet_header *packet = (struct packet_header *)(packet_buffer + w->pos);
+	PERF_START(t);
+
+	if (w->section != NULL) {
+		finish_section(w);
+	}
+
+	LOG_DBG("finishing packet len=%d at %u", w->len, w->pos);
+
+	uint32_t packet_end = sizeof(struct packet_header) + w->len;
+	uint32_t size = PACKET_ALIGN_UP(packet_end);
+	uint32_t end = (w->pos + size) % buffer_size;
+	uint32_t reserve_end = (w->pos + w->max_size) % buffer_size;
+
+	if (size > w->claim) {
+		claim_packet(w, size);
+	}
+	// Zero the alignment byte, so a packet's record only depends on its samples.
+	if (size > packet_end) {
+		packet->data[w->len] = 0;
+	}
+	copy_mirror(w->pos, size);
+
+	// Section headers are counted by finish_section().
+	uint8_t *sections = (uint8_t *)first_section(packet);
+
+	k_spinlock_key_t key = k_spin_lock(&packet_lock);
+
+	packet->len = w->len;
+	packet->committed = 1;
+
+	// Hand the unused tail back if nothing was reserved after us, otherwise pad it out: what
+	// was reserved after us has claimed it already.
+	if (reserve_end == write_pos) {
+		write_pos = end;
+	} else if (size < w->max_size) {
+		put_padding(end, w->max_size - size);
+	}
+
+	header_bytes += (sections - (uint8_t *)packet) + (size - packet_end);
+	anchor_bytes += size;
+
+	publish_packets();
+	buffer_high_water = MAX(buffer_high_water, buffer_used());
+
+	k_spin_unlock(&packet_lock, key);
+	PERF_END(PERF_COMMIT, t, 0);
+}
+
+const uint8_t *channel_finished_record(const struct channel_writer *w, uint16_t *len)
+{
+	*len = PACKET_ALIGN_UP(sizeof(struct packet_header) + w->len);
+	return packet_buffer + w->pos;
+}
+
+uint64_t channel_timestamp()
+{
+	return k_uptime_get_32();
+}
+
+struct packet_cursor {
+	uint32_t pos;
+	uint32_t seq;
+	uint32_t thins;
+	uint64_t timestamp;
+	uint16_t rates[CHANNEL_COUNT];
+	float scales[CHANNEL_COUNT];
+};
+
+struct section_info {
+	uint8_t channel;
+	uint8_t quant;
+	uint8_t codec;
+	uint8_t pred;
+	uint16_t rate;
+	float scale;
+	uint16_t len;
+};
+
+struct packet_info {
+	uint8_t type;
+	uint64_t timestamp;
+	uint16_t len;
+	uint8_t section_count;
+	struct section_info sections[PACKET_MAX_SECTIONS];
+};
+
+// Rates and scales are only known once a section carrying them has been read; until then they
+// read as 0.
+static void rewind_cursor(struct packet_cursor *cursor)
+{
+	cursor->pos = read_pos;
+	cursor->seq = first_seq;
+	cursor->thins = thin_count;
+	cursor->timestamp = first_timestamp;
+	memset(cursor->rates, 0, sizeof(cursor->rates));
+	memset(cursor->scales, 0, sizeof(cursor->scales));
+}
+
+static void start_reading(struct packet_cursor *cursor)
+{
+	k_spinlock_key_t key = k_spin_lock(&packet_lock);
+	rewind_cursor(cursor);
+	k_spin_unlock(&packet_lock, key);
+}
+
+// Copies out the next committed anchor or data packet, skipping padding.
+static bool read_packet(struct packet_cursor *cursor, struct packet_info *info)
+{
+	bool found = false;
+
+	k_spinlock_key_t key = k_spin_lock(&packet_lock);
+
+	// Thinning moves packets around, so positions from before it are stale.
+	for (;;) {
+		if ((int32_t)(cursor->seq - first_seq) < 0 || cursor->thins != thin_count) {
+			LOG_DBG("reader fell behind at %u, restarting at %u", cursor->pos,
+				read_pos);
+			rewind_cursor(cursor);
+		}
+		if (!thin_fenced(cursor->seq)) {
+			break;
+		}
+		key = wait_for_thinning(key);
+	}
+
+	while (!found && cursor->seq != commit_seq) {
+		struct packet_header *packet = packet_at(cursor->pos);
+
+		cursor->timestamp = packet_timestamp(packet, cursor->timestamp);
+		cursor->pos = next_packet_pos(cursor->pos);
+		cursor->seq++;
+
+		if (packet->type == PACKET_PADDING) {
+			continue;
+		}
+
+		info->type = packet->type;
+		info->timestamp = cursor->timestamp;
+		info->len = packet->len;
+		info->section_count = 0;
+		found = true;
+
+		if (packet->type != PACKET_DATA) {
+			continue;
+		}
+
+		for (struct packet_section *section = first_section(packet); section != NULL;
+		     section = next_section(packet, section)) {
+			if (section->has_config) {
+				cursor->rates[section->channel] = section_rate(section);
+			}
+			if (section->has_config && section->quant == QUANTIZE_RAW) {
+				cursor->scales[section->channel] = section_scale(section);
+			}
+			info->sections[info->section_count++] = (struct section_info){
+				.channel = section->channel,
+				.quant = section->quant,
+				.codec = section->codec,
+				.pred = section->pred,
+				.rate = cursor->rates[section->channel],
+				.scale = cursor->scales[section->channel],
+				.len = section->len,
+			};
+		}
+	}
+
+	k_spin_unlock(&packet_lock, key);
+	return found;
+}
+
+// Moves the reader up to the next anchor. Writers repeat every rate and scale after one, so
+// from there on everything decodes; data packets passed over are lost to the reader. If there is
+// none left in the ring, the next packet is made to start with one. Called under packet_lock.
+static void seek_anchor(struct channel_reader *r)
+{
+	while (r->seq != commit_seq) {
+		struct packet_header *packet = packet_at(r->pos);
+		if (packet->type == PACKET_ANCHOR) {
+			r->resync = false;
+			return;
+		}
+
+		r->timestamp = packet_timestamp(packet, r->timestamp);
+		if (packet->type == PACKET_DATA) {
+			add_gap(r, packet, r->timestamp);
+			r->lost++;
+		}
+		r->pos = next_packet_pos(r->pos);
+		r->seq++;
+	}
+	anchor_due = true;
+}
+
+// Writes out and clears the reader's pending gap record.
+static uint16_t put_gap_record(struct channel_reader *r, uint8_t *buf)
+{
+	struct packet_header *packet = (struct packet_header *)buf;
+	uint16_t len = 0;
+
+	for (int ch = 0; ch < CHANNEL_COUNT; ch++) {
+		struct channel_gap *gap = &r->gap[ch];
+		if (!(r->gap_channels & BIT(ch))) {
+			continue;
+		}
+		packet->data[len++] = ch;
+		len += put_varint(packet->data + len, gap->start);
+		len += put_varint(packet->data + len, gap->end);
+		len += put_varint(packet->data + len, gap->samples);
+	}
+
+	packet->len = len;
+	packet->type = PACKET_GAP;
+	packet->committed = 1;
+	r->gap_channels = 0;
+	r->gaps++;
+	return PACKET_ALIGN_UP(sizeof(struct packet_header) + len);
+}
+
+void channel_start_reader(struct channel_reader *r)
+{
+	k_spinlock_key_t key = k_spin_lock(&packet_lock);
+
+	while (thin_fenced(first_seq)) {
+		key = wait_for_thinning(key);
+	}
+
+	bool registered = false;
+	for (int i = 0; i < channel_reader_count; i++) {
+		registered |= channel_readers[i] == r;
+	}
+	if (!registered) {
+		if (channel_reader_count == CHANNEL_MAX_READERS) {
+			k_spin_unlock(&packet_lock, key);
+			LOG_ERR("too many readers");
+			k_oops();
+		}
+		channel_readers[channel_reader_count++] = r;
+	}
+
+	r->pos = read_pos;
+	r->seq = first_seq;
+	r->timestamp = first_timestamp;
+	r->resync = true;
+	seek_anchor(r);
+	// Packets before the first anchor predate the reader, they aren't lost.
+	r->lost = 0;
+	r->gaps = 0;
+	r->gap_channels = 0;
+	k_spin_unlock(&packet_lock, key);
+}
+
+uint16_t channel_read_record(struct channel_reader *r, uint8_t *buf, uint16_t size)
+{
+	uint16_t record_len = 0;
+
+	if (size < GAP_RECORD_MAX_LEN) {
+		LOG_ERR("record buffer too small: %u", size);
+		k_oops();
+	}
+
+	k_spinlock_key_t key = k_spin_lock(&packet_lock);
+
+	while (thin_fenced(r->seq)) {
+		key = wait_for_thinning(key);
+	}
+	if ((int32_t)(r->seq - first_seq) < 0) {
+		r->lost += first_seq - r->seq;
+		r->pos = read_pos;
+		r->seq = first_seq;
+		r->timestamp = first_timestamp;
+		r->resync = true;
+	}
+
+	while (record_len == 0) {
+		if (r->resync) {
+			seek_anchor(r);
+		}
+		// What was lost goes out first, ahead of the anchor the reader picks up again at.
+		if (r->gap_channels != 0) {
+			record_len = put_gap_record(r, buf);
+			break;
+		}
+		if (r->seq == commit_seq) {
+			break;
+		}
+
+		struct packet_header *packet = packet_at(r->pos);
+		uint16_t len = PACKET_ALIGN_UP(sizeof(struct packet_header) + packet->len);
+
+		r->timestamp = packet_timestamp(packet, r->timestamp);
+		r->pos = next_packet_pos(r->pos);
+		r->seq++;
+
+		if (packet->type == PACKET_PADDING) {
+			continue;
+		}
+		// The next packet's timestamp is a delta from this one, so skip to an anchor.
+		if (len > size) {
+			add_gap(r, packet, r->timestamp);
+			r->lost++;
+			r->resync = true;
+			continue;
+		}
+		memcpy(buf, packet, len);
+		record_len = len;
+	}
+
+	k_spin_unlock(&packet_lock, key);
+	return record_len;
+}
+
+uint16_t channel_record_len(const uint8_t *record)
+{
+	const struct packet_header *packet = (const struct packet_header *)record;
+	return PACKET_ALIGN_UP(sizeof(struct packet_header) + packet->len);
+}
+
+void channel_padding_record(uint8_t *buf, uint16_t size)
+{
+	struct packet_header *packet = (struct packet_header *)buf;
+
+	if (size < sizeof(struct packet_header) || (size % PACKET_ALIGN) != 0) {
+		LOG_ERR("bad padding size: %u", size);
+		k_oops();
+	}
+	packet->len = size - sizeof(struct packet_header);
+	packet->type = PACKET_PADDING;
+	packet->committed = 1;
+	memset(packet->data, 0, packet->len);
+}
+
+static int cmd_channel_buffer_size(const struct shell *shell, size_t argc, char *argv[])
+{
+	uint32_t new_size = strtoul(argv[1], NULL, 0);
+	if (new_size < 256 || new_size > PACKET_BUFFER_SIZE || (new_size % PACKET_ALIGN) != 0) {
+		shell_fprintf(shell, SHELL_ERROR, "invalid buffer size: %u (even, 256 to %u)\n",
+			      new_size, PACKET_BUFFER_SIZE);
+		return -1;
+	}
+
+	// Waits for the span being thinned, if any.
+	k_mutex_lock(&thin_lock, K_FOREVER);
+	k_spinlock_key_t key = k_spin_lock(&packet_lock);
+	bool busy = commit_seq != next_seq;
+	if (!busy) {
+		buffer_size = new_size;
+		write_pos = 0;
+		read_pos = 0;
+		commit_pos = 0;
+		first_seq = next_seq;
+		first_timestamp = last_timestamp;
+		anchor_due = true;
+		thin_failed = false;
+		buffer_high_water = 0;
+		for (int ch = 0; ch < CHANNEL_COUNT; ch++) {
+			channel_stats[ch].retained_packets = 0;
+			channel_stats[ch].retained_bytes = 0;
+			channel_stats[ch].retained_since = last_timestamp;
+		}
+	}
+	k_spin_unlock(&packet_lock, key);
+	k_mutex_unlock(&thin_lock);
+
+	if (busy) {
+		shell_fprintf(shell, SHELL_ERROR, "packets are being written, try again\n");
+		return -1;
+	}
+
+	shell_fprintf(shell, SHELL_NORMAL, "channel buffer size is now %u\n", buffer_size);
+	return 0;
+}
+
+static int cmd_channel_log(const struct shell *shell, size_t argc, char *argv[])
+{
+	struct packet_cursor cursor;
+	struct packet_info info;
+
+	start_reading(&cursor);
+
+	while (read_packet(&cursor, &info)) {
+		if (info.type == PACKET_ANCHOR) {
+			shell_fprintf(shell, SHELL_NORMAL, "ts=%llu anchor\n", info.timestamp);
+			continue;
+		}
+		shell_fprintf(shell, SHELL_NORMAL, "ts=%llu len=%u\n", info.timestamp, info.len);
+		for (int i = 0; i < info.section_count; i++) {
+			struct section_info *section = &info.sections[i];
+			shell_fprintf(shell, SHELL_NORMAL,
+				      " ch=%s quant=%s codec=%s pred=%s rate=%u len=%u\n",
+				      channel_names[section->channel],
+				      quantize_names[section->quant], codec_names[section->codec],
+				      predictor_names[section->pred], section->rate, section->len);
+			if (section->quant == QUANTIZE_RAW) {
+				shell_fprintf(shell, SHELL_NORMAL, "  scale=%f\n",
+					      (double)section->scale);
+			}
+		}
+	}
+
+	return 0;
+}
+
+static int cmd_channel_status(const struct shell *shell, size_t argc, char *argv[])
+{
+	k_spinlock_key_t key = k_spin_lock(&packet_lock);
+
+	uint32_t time_window = channel_timestamp() - first_timestamp;
+	uint32_t used = buffer_used();
+	uint32_t high_water = buffer_high_water;
+	uint32_t packets_pending = next_seq - commit_seq;
+	uint32_t failures = reserve_failures;
+	uint32_t thins = thin_count;
+	uint32_t thinned = thin_bytes;
+
+	k_spin_unlock(&packet_lock, key);
+
+	shell_fprintf(shell, SHELL_NORMAL, "buffer status:\n");
+	shell_fprintf(shell, SHELL_NORMAL, " buffer_size: %u\n", buffer_size);
+	shell_fprintf(shell, SHELL_NORMAL, " buffer_used: %u\n", used);
+	shell_fprintf(shell, SHELL_NORMAL, " buffer_high_water: %u\n", high_water);
+	shell_fprintf(shell, SHELL_NORMAL, " time_window: %u\n", time_window);
+	shell_fprintf(shell, SHELL_NORMAL, " packets_pending: %u\n", packets_pending);
+	shell_fprintf(shell, SHELL_NORMAL, " reserve_failures: %u\n", failures);
+	shell_fprintf(shell, SHELL_NORMAL, " keep_share: %u%% thinned: spans=%u bytes=%u\n",
+		      keep_share, thins, thinned);
+	for (int i = 0; i < channel_reader_count; i++) {
+		struct channel_reader *r = channel_readers[i];
+		shell_fprintf(shell, SHELL_NORMAL, " reader %d: behind=%u lost=%u gaps=%u\n", i,
+			      commit_seq - r->seq, r->lost, r->gaps);
+	}
+
+	shell_fprintf(shell, SHELL_NORMAL, "channel status:\n");
+	for (int ch = 0; ch < CHANNEL_COUNT; ch++) {
+		struct channel_stats stats;
+		uint32_t window_samples = 0;
+		uint32_t window_bits = 0;
+		const char *retention;
+
+		key = k_spin_lock(&packet_lock);
+		advance_rate_window(&channel_stats[ch], channel_timestamp() / 1000);
+		stats = channel_stats[ch];
+		retention = retention_names[channel_retention[ch]];
+		k_spin_unlock(&packet_lock, key);
+
+		if (stats.packets == 0) {
+			shell_fprintf(shell, SHELL_NORMAL, " %s: idle\n", channel_names[ch]);
+			continue;
+		}
+
+		for (int i = 0; i < CHANNEL_RATE_WINDOW; i++) {
+			if (i != stats.window_second % CHANNEL_RATE_WINDOW) {
+				window_samples += stats.window_samples[i];
+				window_bits += stats.window_bits[i];
+			}
+		}
+
+		// Raw is what the samples would take as plain 16 bit values.
+		uint32_t raw_bytes = stats.samples * sizeof(int16_t);
+		float encoded_bytes = stats.encoded_bits / 8.0f;
+		float bits_per_sample = (float)stats.encoded_bits / MAX(stats.samples, 1);
+		float ratio = raw_bytes / MAX(encoded_bytes, 1.0f);
+		float samples_per_sec = (float)window_samples / (CHANNEL_RATE_WINDOW - 1);
+		float bytes_per_sec = window_bits / 8.0f / (CHANNEL_RATE_WINDOW - 1);
+		float window_ratio = window_samples * 16.0f / MAX(window_bits, 1);
+		// From the newest packet the channel lost on, so a little longer than what is left.
+		uint32_t time_window =
+			stats.retained_packets > 0 ? channel_timestamp() - stats.retained_since : 0;
+
+		shell_fprintf(shell, SHELL_NORMAL,
+			      " %s: packets=%u samples=%u raw_bytes=%u encoded_bytes=%.0f "
+			      "ratio=%.2f bits/sample=%.2f residual=%d..%d\n",
+			      channel_names[ch], stats.packets, stats.samples, raw_bytes,
+			      (double)encoded_bytes, (double)ratio, (double)bits_per_sample,
+			      stats.residual_min, stats.residual_max);
+		shell_fprintf(shell, SHELL_NORMAL,
+			      "  retained (%s): packets=%u bytes=%u time_window=%u dropped: "
+			      "packets=%u bytes=%u samples=%u\n",
+			      retention, stats.retained_packets, stats.retained_bytes, time_window,
+			      stats.dropped_packets, stats.dropped_bytes, stats.dropped_samples);
+		shell_fprintf(shell, SHELL_NORMAL,
+			      "  last %ds: samples/sec=%.1f bytes/sec=%.1f ratio=%.2f\n",
+			      CHANNEL_RATE_WINDOW - 1, (double)samples_per_sec,
+			      (double)bytes_per_sec, (double)window_ratio);
+	}
+
+	struct codec_stats stats_copy[CODEC_COUNT];
+	uint32_t header_bytes_copy;
+
+	key = k_spin_lock(&packet_lock);
+	memcpy(stats_copy, codec_stats, sizeof(stats_copy));
+	header_bytes_copy = header_bytes;
+	k_spin_unlock(&packet_lock, key);
+
+	uint32_t sample_count = 0;
+
+	shell_fprintf(shell, SHELL_NORMAL, "codec status:\n");
+	for (int codec = 0; codec < CODEC_COUNT; codec++) {
+		struct codec_stats *stats = &stats_copy[codec];
+		sample_count += stats->samples;
+		float bytes_per_sample =
+			(stats->samples > 0) ? ((float)stats->bytes / stats->samples) : 0.0f;
+		shell_fprintf(shell, SHELL_NORMAL,
+			      " %s: packets=%u samples=%u bytes=%u bytes/sample=%.3f\n",
+			      codec_names[codec], stats->packets, stats->samples, stats->bytes,
+			      (double)bytes_per_sample);
+	}
+
+	float header_bytes_per_sample =
+		(sample_count > 0) ? ((float)header_bytes_copy / sample_count) : 0.0f;
+	shell_fprintf(shell, SHELL_NORMAL, " headers: bytes=%u bytes/sample=%.3f\n",
+		      header_bytes_copy, (double)header_bytes_per_sample);
+
+	return 0;
+}
+
+static int cmd_channel_retention(const struct shell *shell, size_t argc, char *argv[])
+{
+	int ch = cmd_table_lookup(shell, channel_names, CHANNEL_COUNT, argv[1]);
+	if (ch < 0) {
+		return -1;
+	}
+	int retention = cmd_table_lookup(shell, retention_names, RETENTION_COUNT, argv[2]);
+	if (retention < 0) {
+		return -1;
+	}
+
+	// thin_span() reads it with packet_lock released.
+	k_mutex_lock(&thin_lock, K_FOREVER);
+	channel_retention[ch] = retention;
+	k_mutex_unlock(&thin_lock);
+	return 0;
+}
+
+static int cmd_channel_keep_share(const struct shell *shell, size_t argc, char *argv[])
+{
+	uint32_t share = strtoul(argv[1], NULL, 0);
+	if (share > 100) {
+		shell_fprintf(shell, SHELL_ERROR, "invalid keep share: %u (0 to 100 percent)\n",
+			      share);
+		return -1;
+	}
+
+	k_mutex_lock(&thin_lock, K_FOREVER);
+	keep_share = share;
+	k_mutex_unlock(&thin_lock);
+	return 0;
+}
+
+static int cmd_channel_codec(const struct shell *shell, size_t argc, char *argv[])
+{
+	int index = cmd_table_lookup(shell, codec_names, CODEC_COUNT, argv[1]);
+	if (index < 0) {
+		return -1;
+	}
+	channel_codec = (enum codec)index;
+	return 0;
+}
+
+//
+// Stress test: several producers at different priorities, so they preempt each other in the
+// middle of packets, some too long to run on across the end of the buffer. Every reader and every
+// eviction runs check_packet(), so running channel log and channel status while this is going
+// exercises the reservation, claim, wrap and commit paths.
+//
+#define CHANNEL_TEST_THREADS 3
+
+struct channel_writer channel_test_writers[CHANNEL_TEST_THREADS];
+
+static void channel_test_thread_main(void *p1, void *, void *)
+{
+	struct channel_writer *w = p1;
+
+	for (;;) {
+        uint64_t timestamp = channel_timestamp();
+        uint32_t sections = sys_rand32_get() % 3 + 1;
+        uint32_t count = sys_rand32_get() % 100 + 1;
+        uint32_t samples_per_sec = 999;
+        if (channel_start_packet(w, timestamp, sections, sections * count)) {
+            for (int s = 0; s < sections; s++) {
+                channel_start_section(w, CHANNEL_NULL, QUANTIZE_1_0, PREDICTOR_ORDER1,
+                                      samples_per_sec);
+                for (int i = 0; i < count; i++) {
+                    channel_add_packet_sample(w, i);
+                }
+            }
+            channel_finish_packet(w);
+        }
+
+        k_msleep(sys_rand32_get() % 20 + 1);
+	}
+}
+
+K_THREAD_STACK_ARRAY_DEFINE(channel_test_thread_stacks, CHANNEL_TEST_THREADS, 512);
+struct k_thread channel_test_threads[CHANNEL_TEST_THREADS];
+
+static int cmd_channel_start_test(const struct shell *shell, size_t argc, char *argv[])
+{
+    for (int i = 0; i < CHANNEL_TEST_THREADS; i++) {
+        k_thread_create(&channel_test_threads[i], channel_test_thread_stacks[i],
+            K_THREAD_STACK_SIZEOF(channel_test_thread_stacks[i]),
+            channel_test_thread_main,
+            &channel_test_writers[i], NULL, NULL,
+            7 + i, 0, K_NO_WAIT);
+    }
+
+    shell_fprintf(shell, SHELL_NORMAL, "channel test started (%d producers)\n",
+                  CHANNEL_TEST_THREADS);
+    return 0;
+}
+
+static int cmd_channel_stop_test(const struct shell *shell, size_t argc, char *argv[])
+{
+    for (int i = 0; i < CHANNEL_TEST_THREADS; i++) {
+        k_thread_abort(&channel_test_threads[i]);
+    }
+
+    shell_fprintf(shell, SHELL_NORMAL, "channel test stopped\n");
+    return 0;
+}
+
+#define CHANNEL_BENCH_PACKETS 100
+#define CHANNEL_BENCH_SAMPLES 32 // one LIS3DH FIFO
+
+enum channel_bench_path {
+	CHANNEL_BENCH_FLOAT,
+	CHANNEL_BENCH_RAW,
+	CHANNEL_BENCH_FLOAT_BATCH,
+	CHANNEL_BENCH_RAW_BATCH,
+	CHANNEL_BENCH_SCALED_BATCH,
+	CHANNEL_BENCH_COUNT
+};
+
+static const char *channel_bench_names[] = {"float", "raw", "float batch", "raw batch",
+					    "scaled batch"};
+
+struct channel_writer channel_bench_writers[CHANNEL_BENCH_COUNT];
+
+// codes and mg are interleaved xyz records, like a LIS3DH FIFO read.
+static void channel_bench_section(struct channel_writer *w, enum channel_bench_path path,
+				  const int16_t *codes, const float *mg)
+{
+	float mg_scale = 1.0f;
+
+	if (path == CHANNEL_BENCH_RAW || path == CHANNEL_BENCH_RAW_BATCH) {
+		channel_start_raw_section(w, CHANNEL_NULL, PREDICTOR_ORDER1, 999, mg_scale);
+	} else {
+		channel_start_section(w, CHANNEL_NULL, QUANTIZE_1_0, PREDICTOR_ORDER1, 999);
+	}
+
+	switch (path) {
+	case CHANNEL_BENCH_FLOAT:
+		for (int i = 0; i < CHANNEL_BENCH_SAMPLES; i++) {
+			channel_add_packet_sample(w, codes[i * 3] * mg_scale);
+		}
+		break;
+	case CHANNEL_BENCH_RAW:
+		for (int i = 0; i < CHANNEL_BENCH_SAMPLES; i++) {
+			channel_add_packet_code(w, codes[i * 3]);
+		}
+		break;
+	case CHANNEL_BENCH_FLOAT_BATCH:
+		channel_add_packet_samples(w, mg, CHANNEL_BENCH_SAMPLES, 3);
+		break;
+	case CHANNEL_BENCH_SCALED_BATCH:
+		channel_add_packet_scaled(w, codes, CHANNEL_BENCH_SAMPLES, 3, mg_scale);
+		break;
+	default:
+		channel_add_packet_codes(w, codes, CHANNEL_BENCH_SAMPLES, 3, 0);
+		break;
+	}
+}
+
+// Times the sample paths on the same synthetic accel codes, round robin packet by packet so all
+// of them see the same ring and interrupt load. At +-2 g high resolution one code is 1 mg, so
+// every path encodes identical integers; each has its own writer so the raw scale is only sent
+// once and the byte counts match up to that. The float batch is timed from already converted
+// values, as DPS368 readings would be; the scaled batch converts as it goes, as LIS3DH reads do.
+static int cmd_channel_bench(const struct shell *shell, size_t argc, char *argv[])
+{
+	static int16_t codes[CHANNEL_BENCH_SAMPLES * 3];
+	static float mg[CHANNEL_BENCH_SAMPLES * 3];
+	uint64_t cycles[CHANNEL_BENCH_COUNT] = {0};
+	uint32_t bytes[CHANNEL_BENCH_COUNT] = {0};
+	uint32_t samples[CHANNEL_BENCH_COUNT] = {0};
+
+	for (int i = 0; i < CHANNEL_BENCH_SAMPLES * 3; i++) {
+		codes[i] = (int16_t)(1000.0f * sinf(0.1f * (i / 3) + i % 3)) +
+			   (int16_t)(sys_rand32_get() % 16) - 8;
+		mg[i] = codes[i];
+	}
+
+	timing_init();
+	timing_start();
+
+	for (int i = 0; i < CHANNEL_BENCH_COUNT * CHANNEL_BENCH_PACKETS; i++) {
+		enum channel_bench_path path = i % CHANNEL_BENCH_COUNT;
+		struct channel_writer *w = &channel_bench_writers[path];
+
+		if (!channel_start_packet(w, channel_timestamp(), 3, 3 * CHANNEL_BENCH_SAMPLES)) {
+			continue;
+		}
+
+		timing_t start = timing_counter_get();
+		for (int axis = 0; axis < 3; axis++) {
+			channel_bench_section(w, path, codes + axis, mg + axis);
+		}
+		channel_finish_packet(w);
+		timing_t end = timing_counter_get();
+
+		cycles[path] += timing_cycles_get(&start, &end);
+		bytes[path] += w->len;
+		samples[path] += 3 * CHANNEL_BENCH_SAMPLES;
+	}
+
+	timing_stop();
+
+	for (int path = 0; path < CHANNEL_BENCH_COUNT; path++) {
+		const char *name = channel_bench_names[path];
+
+		if (samples[path] == 0) {
+			shell_fprintf(shell, SHELL_NORMAL, "%s: no packets\n", name);
+			continue;
+		}
+		shell_fprintf(shell, SHELL_NORMAL,
+			      "%s: codec=%s samples=%u cycles/sample=%llu ns/sample=%llu "
+			      "bytes/sample=%.2f\n",
+			      name, codec_names[channel_codec], samples[path],
+			      cycles[path] / samples[path],
+			      timing_cycles_to_ns(cycles[path]) / samples[path],
+			      (double)bytes[path] / samples[path]);
+	}
+
+	return 0;
 }
 
 SHELL_STATIC_SUBCMD_SET_CREATE(
 	channel_cmds,
+	SHELL_CMD_ARG(bench, NULL, "time the sample paths", cmd_channel_bench, 1, 0),
 	SHELL_CMD_ARG(buffer_size, NULL, "set buffer size", cmd_channel_buffer_size, 2, 0),
+	SHELL_CMD_ARG(codec, NULL, CODEC_HELP, cmd_channel_codec, 2, 0),
+	SHELL_CMD_ARG(keep_share, NULL, "percent of the buffer thinned spans may take",
+		      cmd_channel_keep_share, 2, 0),
 	SHELL_CMD_ARG(log, NULL, "print packets in buffer", cmd_channel_log, 1, 0),
+	SHELL_CMD_ARG(retention, NULL, "<channel> bulk|keep", cmd_channel_retention, 3, 0),
 	SHELL_CMD_ARG(status, NULL, "print channels status", cmd_channel_status, 1, 0),
     SHELL_CMD_ARG(start_test, NULL, "start channel test", cmd_channel_start_test, 1, 0),
     SHELL_CMD_ARG(stop_test, NULL, "stop channel test", cmd_channel_stop_test, 1, 0),
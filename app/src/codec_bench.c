@@ -0,0 +1,192 @@
+#include "common.h"
+#include "codec_bench_trace.h"
+
+#include <zephyr/sys/crc.h>
+
+//
+// Codec benchmark: replays synthetic and recorded traces through the normal packet path for
+// every quantize setting and codec, one section per packet as a sensor would write them, and
+// reports bytes/sample, packets/s and ns/sample. Each run also prints a CRC of its samples as
+// quantized, and with `dump` every packet it wrote in the same hex as `recorder dump`, so
+// scripts/plot/codec_bench.py can decode the transcript and check the round trip bit for bit.
+// The packets go through the ring like any other, under real channel ids: they evict whatever
+// was buffered and reach a live stream, and the bench won't run while recording so that none of
+// them end up in a session.
+//
+#define CODEC_BENCH_SAMPLES    1024
+#define CODEC_BENCH_PACKET_LEN 32 // samples, one encoder batch
+#define CODEC_BENCH_DUMP_LINE  32
+
+enum codec_bench_trace_id {
+	CODEC_BENCH_ACCEL,
+	CODEC_BENCH_SHOCK,
+	CODEC_BENCH_PRESSURE,
+	CODEC_BENCH_TEMPERATURE,
+	CODEC_BENCH_RECORDED,
+	CODEC_BENCH_TRACES
+};
+
+struct codec_bench_trace {
+	const char *name;
+	enum channel channel;
+	uint16_t rate;
+};
+
+static const struct codec_bench_trace codec_bench_traces[CODEC_BENCH_TRACES] = {
+	[CODEC_BENCH_ACCEL] = {"accel", CHANNEL_ACCEL_X, 400},
+	[CODEC_BENCH_SHOCK] = {"shock", CHANNEL_ACCEL_Z, 1600},
+	[CODEC_BENCH_PRESSURE] = {"pressure", CHANNEL_PRESSURE, 64},
+	[CODEC_BENCH_TEMPERATURE] = {"temperature", CHANNEL_TEMPERATURE, 8},
+	[CODEC_BENCH_RECORDED] = {"recorded", CHANNEL_ACCEL_Z, 100},
+};
+
+struct channel_writer codec_bench_writer;
+
+// Fixed seed, so every run of a trace sees the same samples.
+static float codec_bench_noise(uint32_t *state, float amplitude)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	return amplitude * ((int32_t)(*state % 2001) - 1000) / 1000.0f;
+}
+
+// Sample i of a trace in its channel's units: mg, Pa or degC.
+static float codec_bench_sample(enum codec_bench_trace_id trace, uint32_t i, uint32_t *state)
+{
+	float t = (float)i / codec_bench_traces[trace].rate;
+
+	switch (trace) {
+	case CODEC_BENCH_ACCEL: // cornering: a slow 1 g swing plus engine vibration
+		return 1000.0f * sinf(2.0f * 3.14159f * 0.5f * t) +
+		       150.0f * sinf(2.0f * 3.14159f * 37.0f * t) + codec_bench_noise(state, 8.0f);
+	case CODEC_BENCH_SHOCK: { // kerb strikes: decaying impulses every 200 samples on 1 g
+		float shock = 6000.0f * expf(-0.05f * (i % 200));
+		return 1000.0f + ((i / 200) % 2 ? -shock : shock) + codec_bench_noise(state, 16.0f);
+	}
+	case CODEC_BENCH_PRESSURE:
+		return 101325.0f + 30.0f * sinf(0.05f * t) + codec_bench_noise(state, 2.0f);
+	case CODEC_BENCH_TEMPERATURE:
+		return 25.0f + 2.0f * sinf(0.01f * t) + codec_bench_noise(state, 0.02f);
+	default:
+		return codec_bench_recorded[i % ARRAY_SIZE(codec_bench_recorded)];
+	}
+}
+
+// Prints the packet the writer just finished. One that ran across the end of the ring is still
+// in one piece in the mirror, and nothing can evict it before the writer starts the next one.
+static void codec_bench_dump(const struct shell *shell, struct channel_writer *w)
+{
+	uint16_t len;
+	const uint8_t *record = channel_finished_record(w, &len);
+	char hex[2 * CODEC_BENCH_DUMP_LINE + 1];
+
+	for (uint32_t offset = 0; offset < len; offset += CODEC_BENCH_DUMP_LINE) {
+		uint32_t n = MIN(len - offset, CODEC_BENCH_DUMP_LINE);
+		for (uint32_t i = 0; i < n; i++) {
+			snprintf(hex + 2 * i, 3, "%02X", record[offset + i]);
+		}
+		shell_fprintf(shell, SHELL_NORMAL, "%s\n", hex);
+	}
+}
+
+static void codec_bench_run(const struct shell *shell, enum codec_bench_trace_id trace,
+			    enum quantize quant, enum codec codec, bool dump)
+{
+	const struct codec_bench_trace *info = &codec_bench_traces[trace];
+	struct channel_writer *w = &codec_bench_writer;
+	enum channel ch = info->channel;
+	uint32_t state = 0x2545f491 + trace;
+	uint64_t cycles = 0;
+	uint32_t bytes = 0;
+	uint32_t packets = 0;
+	uint32_t failures = 0;
+	uint32_t clamped = 0;
+	uint16_t crc = 0;
+
+	shell_fprintf(shell, SHELL_NORMAL, "codec_bench: trace=%s quant=%s codec=%s\n", info->name,
+		      quantize_names[quant], codec_names[codec]);
+	// Pinned to the writer, so live packets keep channel_codec while the bench runs.
+	w->codec_pinned = true;
+	w->pinned_codec = codec;
+
+	for (uint32_t i = 0; i < CODEC_BENCH_SAMPLES; i += CODEC_BENCH_PACKET_LEN) {
+		float values[CODEC_BENCH_PACKET_LEN];
+		int16_t codes[CODEC_BENCH_PACKET_LEN];
+
+		for (int j = 0; j < CODEC_BENCH_PACKET_LEN; j++) {
+			values[j] = codec_bench_sample(trace, i + j, &state);
+			// Raw runs feed the same values rounded to integer codes, one per unit.
+			int32_t si = channel_quantize(values[j], quant);
+			codes[j] = CLAMP(si, INT16_MIN, INT16_MAX);
+			clamped += codes[j] != si;
+		}
+
+		timing_t start = timing_counter_get();
+		if (!channel_start_packet(w, channel_timestamp(), 1, CODEC_BENCH_PACKET_LEN)) {
+			failures++;
+			continue;
+		}
+		if (quant == QUANTIZE_RAW) {
+			channel_start_raw_section(w, ch, PREDICTOR_ORDER1, info->rate, 1.0f);
+			channel_add_packet_codes(w, codes, CODEC_BENCH_PACKET_LEN, 1, 0);
+		} else {
+			channel_start_section(w, ch, quant, PREDICTOR_ORDER1, info->rate);
+			channel_add_packet_samples(w, values, CODEC_BENCH_PACKET_LEN, 1);
+		}
+		channel_finish_packet(w);
+		timing_t end = timing_counter_get();
+
+		cycles += timing_cycles_get(&start, &end);
+		bytes += w->len;
+		packets++;
+		// Only what made it into a packet counts towards the round trip.
+		crc = crc16_ccitt(crc, (uint8_t *)codes, sizeof(codes));
+
+		if (dump) {
+			codec_bench_dump(shell, w);
+		}
+	}
+
+	uint32_t samples = packets * CODEC_BENCH_PACKET_LEN;
+	uint64_t ns = timing_cycles_to_ns(cycles);
+
+	shell_fprintf(shell, SHELL_NORMAL,
+		      "codec_bench: samples=%u bytes/sample=%.2f packets/s=%u ns/sample=%llu "
+		      "clamped=%u failures=%u crc=%04x\n",
+		      samples, samples ? (double)bytes / samples : 0.0,
+		      ns ? (uint32_t)(packets * 1000000000ull / ns) : 0, samples ? ns / samples : 0,
+		      clamped, failures, crc);
+}
+
+static int cmd_codec_bench(const struct shell *shell, size_t argc, char *argv[])
+{
+	bool dump = argc > 1 && strcmp(argv[1], "dump") == 0;
+
+	if (argc > 1 && !dump) {
+		shell_fprintf(shell, SHELL_ERROR, "usage: codec_bench [dump]\n");
+		return -1;
+	}
+	if (recorder_hold()) {
+		shell_fprintf(shell, SHELL_ERROR, "stop recording first\n");
+		return -EBUSY;
+	}
+
+	timing_init();
+	timing_start();
+
+	for (int trace = 0; trace < CODEC_BENCH_TRACES; trace++) {
+		for (int quant = 0; quant < QUANTIZE_COUNT; quant++) {
+			for (int c = 0; c < CODEC_COUNT; c++) {
+				codec_bench_run(shell, trace, quant, c, dump);
+			}
+		}
+	}
+
+	timing_stop();
+	recorder_release();
+	return 0;
+}
+
+SHELL_CMD_ARG_REGISTER(codec_bench, NULL, "[dump] replay traces through every codec",
+		       cmd_codec_bench, 1, 1);
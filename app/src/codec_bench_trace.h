@@ -0,0 +1,91 @@
+// Generated by scripts/plot/codec_bench.py --write-trace - do not edit.
+
+#ifndef CODEC_BENCH_TRACE_H
+#define CODEC_BENCH_TRACE_H
+
+// accel.z in mg from scripts/plot/sample_log.txt, 100 Hz.
+static const int16_t codec_bench_recorded[] = {
+	948, 952, 952, 952, 948, 948, 948, 948, 948, 952, 952, 952,
+	952, 948, 948, 948, 952, 952, 952, 952, 948, 952, 948, 948,
+	948, 952, 956, 952, 948, 948, 948, 952, 952, 952, 956, 956,
+	952, 952, 948, 948, 944, 944, 948, 948, 948, 948, 948, 952,
+	952, 952, 948, 948, 948, 952, 952, 952, 952, 952, 952, 952,
+	948, 948, 952, 948, 952, 952, 952, 948, 948, 948, 944, 948,
+	948, 948, 948, 952, 952, 948, 952, 948, 952, 952, 948, 948,
+	948, 948, 948, 944, 948, 948, 948, 952, 952, 956, 952, 952,
+	952, 952, 948, 952, 952, 952, 952, 948, 948, 952, 952, 952,
+	952, 948, 948, 948, 952, 952, 952, 948, 952, 952, 948, 948,
+	952, 952, 952, 944, 948, 952, 948, 948, 948, 952, 952, 948,
+	948, 948, 948, 948, 952, 948, 948, 948, 948, 952, 948, 952,
+	952, 948, 948, 944, 944, 948, 952, 952, 952, 948, 952, 952,
+	952, 948, 948, 948, 948, 948, 952, 956, 956, 952, 952, 948,
+	948, 948, 948, 948, 944, 944, 944, 948, 948, 952, 948, 948,
+	948, 940, 940, 948, 948, 948, 948, 952, 952, 952, 952, 956,
+	952, 952, 948, 948, 948, 948, 948, 948, 948, 948, 948, 948,
+	948, 948, 952, 948, 952, 948, 948, 952, 948, 948, 948, 952,
+	948, 948, 948, 948, 948, 952, 948, 948, 948, 948, 948, 952,
+	952, 948, 948, 948, 948, 948, 952, 956, 956, 952, 956, 952,
+	948, 952, 952, 952, 952, 952, 948, 948, 952, 948, 948, 952,
+	952, 952, 948, 968, 956, 940, 944, 948, 952, 940, 928, 936,
+	932, 948, 952, 952, 948, 976, 948, 952, 940, 944, 964, 980,
+	1076, 1000, 904, 856, 900, 928, 924, 920, 932, 936, 936, 936,
+	948, 964, 964, 968, 976, 984, 976, 976, 980, 984, 992, 1000,
+	1008, 948, 1012, 1016, 1036, 1036, 1024, 1012, 1020, 1020, 1028, 1044,
+	1060, 1064, 1068, 1068, 1076, 1072, 1064, 1056, 1040, 1036, 1028, 1028,
+	1012, 996, 984, 960, 924, 908, 880, 1008, 800, 756, 724, 676,
+	624, 592, 568, 548, 564, 604, 660, 728, 820, 948, 1116, 1268,
+	1384, 1456, 1488, 1512, 1508, 1512, 1536, 1548, 1516, 1448, 1352, 1228,
+	1120, 1008, 952, 880, 808, 740, 676, 632, 584, 564, 524, 480,
+	420, 368, 344, 384, 488, 596, 700, 808, 920, 1056, 1168, 1264,
+	1356, 1432, 1476, 1528, 1528, 1500, 1464, 1008, 1348, 1296, 1244, 1152,
+	1036, 912, 804, 724, 680, 648, 636, 656, 624, 588, 552, 556,
+	584, 636, 696, 776, 848, 920, 980, 1048, 1100, 1144, 1176, 1200,
+	1212, 1232, 948, 1268, 1244, 1208, 1184, 1188, 1168, 1116, 1084, 1032,
+	928, 848, 788, 744, 708, 680, 664, 692, 748, 792, 804, 808,
+	824, 812, 816, 860, 860, 872, 840, 836, 1232, 904, 916, 968,
+	992, 1004, 1016, 1024, 1020, 980, 908, 860, 872, 872, 864, 852,
+	808, 764, 748, 760, 780, 812, 844, 868, 896, 904, 912, 908,
+	880, 848, 1232, 808, 816, 844, 892, 916, 932, 940, 948, 936,
+	932, 936, 976, 1016, 1040, 1088, 1092, 1076, 1056, 1024, 960, 952,
+	908, 884, 888, 868, 864, 856, 860, 872, 1232, 904, 900, 896,
+	872, 848, 804, 768, 752, 760, 804, 804, 860, 964, 1044, 1148,
+	1220, 1268, 1308, 1316, 1312, 1312, 1280, 1196, 1068, 932, 796, 680,
+	596, 528, 1232, 408, 452, 520, 572, 636, 752, 900, 1052, 1184,
+	1296, 1372, 1412, 1432, 1432, 1420, 1380, 1336, 1280, 1224, 1148, 1048,
+	952, 852, 760, 668, 584, 520, 460, 424, 1232, 440, 460, 492,
+	536, 588, 636, 684, 756, 852, 960, 1064, 1172, 1240, 1292, 1332,
+	1344, 1336, 1328, 1292, 1236, 1164, 1084, 980, 1128, 1584, 924, 752,
+	560, 512, 1232, 492, 524, 544, 604, 692, 776, 860, 940, 992,
+	1008, 1016, 1036, 1072, 1104, 1148, 1180, 1192, 1172, 1128, 1060, 1000,
+	948, 892, 848, 808, 772, 744, 716, 692, 1232, 668, 644, 636,
+	620, 580, 596, 664, 776, 944, 1120, 1292, 1412, 1476, 1492, 1472,
+	1444, 1380, 1296, 1180, 1040, 900, 768, 668, 584, 528, 464, 416,
+	412, 424, 1232, 584, 652, 756, 832, 932, 1024, 1100, 1172, 1260,
+	1344, 1412, 1440, 1440, 1396, 1320, 1236, 1144, 1044, 936, 824, 728,
+	640, 580, 516, 452, 388, 348, 336, 328, 1232, 428, 544, 688,
+	844, 1048, 1264, 1460, 1616, 1728, 1768, 1780, 1744, 1696, 1600, 1484,
+	1340, 1180, 1040, 928, 820, 704, 608, 532, 484, 384, 316, 280,
+	228, 200, 1232, 132, 104, 84, 224, 332, 496, 656, 812, 960,
+	1032, 1036, 1044, 1052, 1088, 1152, 1252, 1372, 1552, 1660, 1672, 1660,
+	1696, 1732, 1796, 1684, 1580, 1364, 1168, 1028, 1232, 884, 812, 792,
+	788, 768, 736, 676, 616, 588, 500, 412, 388, 336, 308, 276,
+	236, 268, 312, 376, 452, 524, 576, 704, 796, 832, 908, 1020,
+	1140, 1268, 1368, 948, 1580, 1684, 1760, 1812, 1832, 1800, 1708, 1576,
+	1412, 1208, 1024, 884, 784, 700, 612, 532, 476, 380, 308, 292,
+	256, 212, 184, 204, 224, 296, 408, 672, 872, 1368, 1152, 1196,
+	1248, 1304, 1372, 1420, 1464, 1492, 1492, 1480, 1436, 1364, 1284, 1188,
+	1084, 992, 912, 840, 764, 712, 624, 592, 572, 532, 508, 488,
+	476, 456, 480, 1368, 516, 552, 608, 644, 716, 804, 932, 1064,
+	1192, 1308, 1364, 1364, 1348, 1324, 1308, 1288, 1276, 1264, 1220, 1176,
+	1116, 1056, 984, 920, 848, 780, 708, 628, 576, 1368, 468, 436,
+	436, 452, 524, 600, 672, 764, 892, 1052, 1228, 1372, 1472, 1536,
+	1576, 1568, 1532, 1452, 1352, 1256, 1172, 1064, 940, 816, 712, 616,
+	544, 552, 488, 472, 948, 424, 436, 460, 508, 560, 624, 740,
+	844, 984, 1100, 1160, 1188, 1200, 1188, 1168, 1124, 1060, 1020, 980,
+	956, 944, 920, 904, 888, 872, 860, 848, 836, 852, 472, 900,
+	908, 916, 960, 968, 956, 928, 896, 880, 908, 932, 952, 940,
+	928, 912, 900, 920, 956, 992, 1012, 1000, 1004, 1000, 980, 944,
+	920, 904, 900, 908, 472,
+};
+
+#endif
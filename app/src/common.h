@@ -7,6 +7,7 @@
 #include <zephyr/logging/log.h>
 #include <zephyr/random/random.h>
 #include <zephyr/shell/shell.h>
+#include <zephyr/timing/timing.h>
 
 #include <math.h>
 #include <stdbool.h>
@@ -31,29 +32,322 @@ enum quantize
     QUANTIZE_0_01,
     QUANTIZE_0_001,
     QUANTIZE_0_0001,
+    QUANTIZE_RAW, // native sensor codes, see channel_start_raw_section()
     QUANTIZE_COUNT
 };
 
 extern const char *quantize_names[QUANTIZE_COUNT];
 #define QUANTIZE_HELP "1.0|0.1|0.01|0.001|0.0001"
+#define QUANTIZE_RAW_HELP QUANTIZE_HELP "|raw"
+
+enum codec
+{
+    CODEC_DELTA8,
+    CODEC_RANS,
+    CODEC_RICE,
+    CODEC_COUNT
+};
+
+extern const char *codec_names[CODEC_COUNT];
+#define CODEC_HELP "delta8|rans|rice"
+
+enum predictor
+{
+    PREDICTOR_ORDER0,
+    PREDICTOR_ORDER1,
+    PREDICTOR_ORDER2,
+    PREDICTOR_LPC,
+    PREDICTOR_COUNT
+};
+
+extern const char *predictor_names[PREDICTOR_COUNT];
+#define PREDICTOR_HELP "order0|order1|order2|lpc"
 
 int cmd_table_lookup(const struct shell *shell, const char **table, size_t table_size, const char *value);
 
+// Pipeline stages timed by perf.c with CONFIG_APP_PERF. Without it the PERF_ macros expand to
+// nothing, timer variables included.
+enum perf_stage
+{
+    PERF_SPI_REG,         // register reads and writes, items are bytes
+    PERF_SPI_BURST,       // stream start to data in hand, items are bytes
+    PERF_DPS368_COMP,     // compensation polynomials, items are FIFO entries
+    PERF_ENCODE,          // quantize, predict and code, items are samples
+    PERF_RESERVE,         // channel_start_packet()
+    PERF_COMMIT,          // channel_finish_packet()
+    PERF_SERVICE,         // one scheduler service, items are FIFO entries
+    PERF_STAGE_COUNT
+};
+
+#ifdef CONFIG_APP_PERF
+uint32_t perf_cycles(void);
+void perf_add(enum perf_stage stage, uint32_t cycles, uint32_t items);
+
+#define PERF_START(t)               uint32_t t = perf_cycles()
+#define PERF_END(stage, t, items)   perf_add(stage, perf_cycles() - (t), items)
+// For stages spread through a loop: PERF_SUM() adds each stretch since PERF_START() to sum.
+#define PERF_SUM_DEFINE(sum)        uint32_t sum = 0
+#define PERF_SUM(sum, t)            sum += perf_cycles() - (t)
+#define PERF_ADD(stage, sum, items) perf_add(stage, sum, items)
+#else
+#define PERF_START(t)
+#define PERF_END(stage, t, items)
+#define PERF_SUM_DEFINE(sum)
+#define PERF_SUM(sum, t)
+#define PERF_ADD(stage, sum, items)
+#endif
+
 uint8_t spi_read_uint8(const struct spi_dt_spec *spec, uint8_t reg);
 void spi_write_uint8(const struct spi_dt_spec *spec, uint8_t reg, uint8_t val);
+int spi_read_buf(const struct spi_dt_spec *spec, uint8_t reg, uint16_t len, uint8_t *buf);
+
+extern uint32_t spi_transactions;
+
+// Transactions and bytes clocked per chip select; higher ones share the last slot.
+#define SPI_MAX_DEVICES 2
+
+struct spi_device_stats {
+	uint32_t transactions;
+	uint32_t bytes;
+};
+
+extern struct spi_device_stats spi_device_stats[SPI_MAX_DEVICES];
+
+struct spi_stream {
+	uint8_t *bufs[2];
+	uint16_t size;
+	uint8_t fill;
+	bool busy;
+	uint8_t cmd;
+	uint16_t len;
+	int result;
+	struct k_sem done;
+	struct spi_buf tx;
+	struct spi_buf rx[2];
+	struct spi_buf_set txs;
+	struct spi_buf_set rxs;
+	uint32_t start_cycles;
+	uint32_t busy_cycles;
+#ifdef CONFIG_APP_PERF
+	uint32_t perf_start;
+#endif
+	uint32_t transfers;
+	uint32_t bytes;
+};
+
+// Defines a stream with two static buffers of size bytes each.
+#define SPI_STREAM_DEFINE(name, buf_size)                                                          \
+	static uint8_t name##_bufs[2][buf_size] __aligned(4);                                      \
+	struct spi_stream name = {                                                                 \
+		.bufs = {name##_bufs[0], name##_bufs[1]},                                          \
+		.size = buf_size,                                                                  \
+		.done = Z_SEM_INITIALIZER(name.done, 0, 1),                                        \
+	}
+
+// Starts reading len bytes after sending cmd into the stream's free buffer. spi_stream_wait()
+// returns that buffer once the transfer is done, or NULL if it failed; the buffer stays valid
+// until the read after next is started.
+int spi_stream_start(const struct spi_dt_spec *spec, struct spi_stream *stream, uint8_t cmd,
+		     uint16_t len);
+uint8_t *spi_stream_wait(struct spi_stream *stream);
 
 uint64_t channel_timestamp();
 
-bool channel_start_packet(enum channel ch, enum quantize quant, uint64_t ts, uint16_t rate, uint16_t sample_count);
-void channel_add_packet_sample(float s);
-void channel_finish_packet();
+struct packet_section;
+
+// Each producer thread owns a writer: it holds the reserved packet, how much of it has been
+// claimed so far and the codec state, so the shared ring is only touched to reserve, claim and
+// commit. It also remembers the last rate and scale it sent per channel, so they are only
+// repeated after a change or a new anchor.
+struct channel_writer {
+	uint32_t pos;
+	uint32_t claim;
+	uint32_t max_size;
+	uint16_t len;
+	uint8_t sections_left;
+	uint32_t anchor;
+	struct packet_section *section;
+	uint8_t *data;
+	uint16_t section_len;
+	uint8_t codec;
+	// Sections take channel_codec unless the writer pins its own, as the codec bench does.
+	bool codec_pinned;
+	uint8_t pinned_codec;
+	uint8_t quant;
+	uint8_t pred;
+	int32_t last_sample;
+	int32_t prev_sample;
+	uint16_t samples;
+	uint32_t bit_acc;
+	uint8_t bit_count;
+	uint32_t rice_sum;
+	int32_t residual_min;
+	int32_t residual_max;
+	uint16_t rate[CHANNEL_COUNT];
+	float scale[CHANNEL_COUNT];
+	uint32_t config_anchor[CHANNEL_COUNT];
+};
+
+// Once channel_start_packet() returns true the packet must be finished: readers don't see the
+// packets reserved after it until it is.
+bool channel_start_packet(struct channel_writer *w, uint64_t ts, uint8_t section_count,
+			  uint16_t sample_count);
+void channel_start_section(struct channel_writer *w, enum channel ch, enum quantize quant,
+			   enum predictor pred, uint16_t rate);
+void channel_add_packet_sample(struct channel_writer *w, float s);
+// Raw sections skip quantization: samples are the sensor's own integer codes, and scale (the
+// size of one code in the channel's units) goes out with the rate instead of with every sample.
+void channel_start_raw_section(struct channel_writer *w, enum channel ch, enum predictor pred,
+			       uint16_t rate, float scale);
+void channel_add_packet_code(struct channel_writer *w, int16_t code);
+// Batched forms: n samples taken every stride elements, so interleaved FIFO reads can be passed
+// in place. Codes are shifted right by shift first, for sensors with left-justified words.
+void channel_add_packet_samples(struct channel_writer *w, const float *s, uint16_t n,
+				uint16_t stride);
+void channel_add_packet_codes(struct channel_writer *w, const int16_t *codes, uint16_t n,
+			      uint16_t stride, uint8_t shift);
+// Quantizes codes times scale, for quantized sections fed straight from a sensor's FIFO.
+void channel_add_packet_scaled(struct channel_writer *w, const int16_t *codes, uint16_t n,
+			       uint16_t stride, float scale);
+void channel_finish_packet(struct channel_writer *w);
+// The record the writer last finished, in one piece even across the end of the ring. It stays
+// valid until the writer starts its next packet.
+const uint8_t *channel_finished_record(const struct channel_writer *w, uint16_t *len);
+// The code a quantized section stores for s, rounded half away from zero.
+int32_t channel_quantize(float s, enum quantize quant);
+
+// Copies committed packets out of the ring as whole records (2 byte header, payload, padded to
+// 2 bytes), the same layout the host decoder walks. A reader starts at the oldest anchor in the
+// ring; one that falls behind eviction counts the packets it lost and carries on at the next
+// anchor, so what it copies always decodes on its own. What it lost is first handed out as a gap
+// record: per channel the timestamps of the first and last lost packet and their sample count.
+struct channel_gap {
+	uint64_t start;
+	uint64_t end;
+	uint32_t samples;
+};
+
+struct channel_reader {
+	uint32_t pos;
+	uint32_t seq;
+	uint64_t timestamp;
+	uint32_t lost;
+	uint32_t gaps;
+	bool resync;
+	uint8_t gap_channels;
+	struct channel_gap gap[CHANNEL_COUNT];
+};
+
+void channel_start_reader(struct channel_reader *r);
+// Returns the length of the record copied into buf, or 0 if there is no committed packet left.
+// Packets longer than size are counted as lost, along with those up to the next anchor. Waits
+// while the packets up next are being thinned.
+uint16_t channel_read_record(struct channel_reader *r, uint8_t *buf, uint16_t size);
+uint16_t channel_record_len(const uint8_t *record);
+// Fills size bytes of buf with one padding record, which readers skip.
+void channel_padding_record(uint8_t *buf, uint16_t size);
+
+int rans_encode(enum channel ch, enum quantize quant, uint8_t *data, uint16_t len);
+
+// A FIFO sensor drained by the scheduler thread. The scheduler models how fast the FIFO fills
+// and wakes before it reaches the watermark; fill_rate and service run on that thread.
+struct sched_sensor {
+	const char *name;
+	// Modelled fill rate for the current settings, in FIFO entries per 1000 s.
+	uint32_t (*fill_rate)(void);
+	// Drains the FIFO and returns the number of entries read, or a negative error.
+	int (*service)(void);
+	// Programs the sensor with its current settings, see sched_reconfigure().
+	void (*config)(void);
+	// Optional: encodes what the last service kept back, once the scheduler stops.
+	void (*flush)(void);
+	uint8_t depth;
+	uint8_t watermark;
+
+	atomic_t flags;
+	int64_t last_ms;
+	int64_t deadline_ms;
+	uint32_t period_ms;
+	uint32_t observed_rate;
+	uint32_t services;
+	uint32_t kicked;
+	uint32_t due;
+	uint32_t coalesced;
+	uint8_t max_fill;
+};
+
+void sched_register(struct sched_sensor *sensor);
+// Services the sensor on the next pass, e.g. from its FIFO interrupt. Callable from ISRs.
+void sched_kick(struct sched_sensor *sensor);
+// Has the scheduler thread call the sensor's config between two services and restart its fill
+// model, so settings changed from other threads never take effect part way through a service.
+void sched_reconfigure(struct sched_sensor *sensor);
+void sched_init(void);
+// Stops the scheduler thread between two services and waits for it to return.
+void sched_stop(void);
+
+extern uint32_t sched_wakeups;
+
+void recorder_init(void);
+int recorder_start(void);
+void recorder_stop(void);
+// Keeps sessions from starting until recorder_release(), for benches that write into the ring.
+// -EBUSY while one is running.
+int recorder_hold(void);
+void recorder_release(void);
+
+extern uint32_t recorder_bytes;
+extern uint32_t recorder_erases;
+extern uint32_t recorder_wakeups;
+
+void stream_init(void);
+// Estimated radio-on time since bluetooth was enabled: advertising, connection events and
+// notifications.
+uint64_t stream_radio_us(void);
+
+extern uint32_t stream_wakeups;
+
+void rtt_init(void);
+
+extern uint32_t rtt_wakeups;
 
 void dps368_init(void);
 void dps368_latest(float *temperature, float *pressure);
 void dps368_stop(void);
 
+extern uint64_t dps368_measure_us;
+
 void lis3dh_init(void);
 void lis3dh_latest(float *x, float *y, float *z);
+// Output data rate lis3dh_wake_on_z() leaves the LIS3DH at through System OFF.
+#define LIS3DH_WAKE_RATE_HZ 1
 void lis3dh_wake_on_z(void);
+// Output data rate in Hz, 0 when powered down.
+uint32_t lis3dh_sample_rate(bool *low_power);
+
+extern uint32_t main_event_waits;
+extern uint64_t main_event_wait_ms;
+
+// Charge estimate from the counters above, see energy.c. energy_mark() starts counting afresh and
+// energy_log() logs the estimate since, e.g. before powering off.
+void energy_mark(void);
+void energy_log(void);
+
+// Sensor emulators for native_sim, see emul.c. Both sample one waveform at the time each sample
+// is taken.
+struct emul_frame {
+	float accel[3];    // mg
+	float pressure;    // Pa
+	float temperature; // degC
+};
+
+uint64_t emul_time_us(void);
+void emul_frame(uint64_t t_us, struct emul_frame *f);
+// Clocks a transfer through xfer one byte at a time: pos counts from the command byte, mosi is 0
+// past the end of tx, and what xfer returns lands in rx where it has a buffer.
+void emul_spi_io(const struct spi_buf_set *tx, const struct spi_buf_set *rx,
+		 uint8_t (*xfer)(void *ctx, size_t pos, uint8_t mosi), void *ctx);
+void lis3dh_emul_status(const struct shell *shell);
+void dps368_emul_status(const struct shell *shell);
 
 #endif
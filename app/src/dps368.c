@@ -4,7 +4,6 @@
 // TODO:
 // + Fix fifo overrun logging
 // + Use P and T shift
-// + Adjust sleep timers for oversampling?
 //
 
 LOG_MODULE_REGISTER(dps368);
@@ -32,6 +31,10 @@ LOG_MODULE_REGISTER(dps368);
 
 #define DPS368_REG_PRODUCT_ID                   0x0D
 #define DPS368_REG_COEF                         0x10
+#define DPS368_COEF_LEN                         18
+
+#define DPS368_FIFO_SIZE                        32
+#define DPS368_FIFO_ENTRY_LEN                   3
 
 enum dps368_rate {
 	DPS368_RATE_1_HZ,
@@ -69,21 +72,51 @@ static float c01, c11, c21;
 const float dps368_scaling_facts[] = {524288.0f, 1572864.0f, 3670016.0f, 7864320.0f,
 				      253952.0f, 516096.0f,  1040384.0f, 2088960.0f};
 
-enum dps368_rate dps368_prs_rate = DPS368_RATE_64_HZ;
-enum dps368_rate dps368_tmp_rate = DPS368_RATE_8_HZ;
+// Settings as last set from the shell. dps368_config() takes them over, so the scheduler thread
+// always compensates FIFO entries with the oversampling they were measured with.
+struct dps368_settings {
+	enum dps368_rate prs_rate;
+	enum dps368_rate tmp_rate;
+	enum dps368_oversampling prs_osr;
+	enum dps368_oversampling tmp_osr;
+};
+
+struct dps368_settings dps368_request = {
+	.prs_rate = DPS368_RATE_64_HZ,
+	.tmp_rate = DPS368_RATE_8_HZ,
+	.prs_osr = DPS368_OSR_1,
+	.tmp_osr = DPS368_OSR_1,
+};
+
+enum dps368_rate dps368_prs_rate;
+enum dps368_rate dps368_tmp_rate;
 
-enum dps368_oversampling dps368_tmp_osr = DPS368_OSR_1;
-enum dps368_oversampling dps368_prs_osr = DPS368_OSR_1;
+enum dps368_oversampling dps368_tmp_osr;
+enum dps368_oversampling dps368_prs_osr;
 
 enum quantize dps368_tmp_quant = QUANTIZE_0_1;
 enum quantize dps368_prs_quant = QUANTIZE_0_1;
 
+enum predictor dps368_tmp_pred = PREDICTOR_ORDER1;
+enum predictor dps368_prs_pred = PREDICTOR_ORDER1;
+
 uint8_t dps368_watermark = 30;
 
 float dps368_latest_tmp_sc;
 float dps368_latest_tmp_comp;
 float dps368_latest_prs_comp;
 
+struct channel_writer dps368_writer;
+
+// Measurement times in 0.1 ms per oversampling rate, from the datasheet.
+static const uint16_t dps368_osr_time_table[] = {36, 52, 84, 148, 276, 532, 1044, 2068};
+
+uint32_t dps368_fifo_drains;
+uint32_t dps368_fifo_entries;
+uint32_t dps368_fifo_transactions;
+// Time spent measuring what was drained, for the energy model.
+uint64_t dps368_measure_us;
+
 static uint32_t dps368_samples_per_sec(enum dps368_rate rate)
 {
 	return 1 << rate;
@@ -97,7 +130,7 @@ static int32_t twoc(uint32_t value, uint8_t bits)
 	return (int32_t)value;
 }
 
-static void dps368_read_fifo()
+static int dps368_read_fifo(void)
 {
 	// LOG_INF("dps368_read_fifo");
 
@@ -110,14 +143,20 @@ static void dps368_read_fifo()
 
 	int prs_count = 0;
 	int tmp_count = 0;
-	float prs_buf[32];
-	float tmp_buf[32];
-
-	for (;;) {
-		uint8_t value[3];
-		value[0] = spi_read_uint8(&dps368, DPS368_REG_PRS_B2);
-		value[1] = spi_read_uint8(&dps368, DPS368_REG_PRS_B1);
-		value[2] = spi_read_uint8(&dps368, DPS368_REG_PRS_B0);
+	float prs_buf[DPS368_FIFO_SIZE];
+	float tmp_buf[DPS368_FIFO_SIZE];
+	PERF_SUM_DEFINE(comp_cycles);
+
+	// Each entry is one 3-byte burst from PRS_B2: reading PRS_B0 pops the FIFO, but the address
+	// auto-increments on to TMP_B2 rather than wrapping, so entries can't share a transaction.
+	// Stop after a FIFO's worth so entries landing mid-drain can't overrun the buffers.
+	while (prs_count + tmp_count < DPS368_FIFO_SIZE) {
+		uint8_t value[DPS368_FIFO_ENTRY_LEN];
+		dps368_fifo_transactions++;
+		if (spi_read_buf(&dps368, DPS368_REG_PRS_B2, sizeof(value), value) < 0) {
+			LOG_ERR("fifo read failed");
+			break;
+		}
 
 		// LOG_INF("raw bytes: %02x %02x %02x", value[0], value[1], value[2]);
 
@@ -125,6 +164,7 @@ static void dps368_read_fifo()
 			break;
 		}
 
+		PERF_START(t);
 		uint32_t mode = value[2] & 1;
 
 		int32_t raw = 0;
@@ -134,6 +174,9 @@ static void dps368_read_fifo()
 		raw = twoc(raw, 24);
 		// LOG_INF("raw: %x", raw);
 
+		enum dps368_oversampling osr = mode ? dps368_prs_osr : dps368_tmp_osr;
+		dps368_measure_us += dps368_osr_time_table[osr] * 100;
+
 		if (mode) {
 			int32_t prs_raw = raw;
 			float prs_sc = (float)prs_raw / dps368_scaling_facts[dps368_prs_osr];
@@ -156,57 +199,90 @@ static void dps368_read_fifo()
 			dps368_latest_tmp_sc = tmp_sc;
 			dps368_latest_tmp_comp = tmp_comp;
 		}
+		PERF_SUM(comp_cycles, t);
 	}
+	PERF_ADD(PERF_DPS368_COMP, comp_cycles, prs_count + tmp_count);
+
+	dps368_fifo_drains++;
+	dps368_fifo_entries += prs_count + tmp_count;
 
 	uint64_t timestamp = channel_timestamp();
+	uint8_t section_count = (prs_count > 0) + (tmp_count > 0);
 
-	if (prs_count > 0) {
-		uint32_t samples_per_sec = dps368_samples_per_sec(dps368_prs_rate);
-		if (channel_start_packet(CHANNEL_PRESSURE, dps368_prs_quant, timestamp, samples_per_sec,
-				 prs_count)) {
-			for (int i = 0; i < prs_count; i++) {
-				channel_add_packet_sample(prs_buf[i]);
-			}
-			channel_finish_packet();
-		}
+	if (section_count == 0) {
+		return 0;
 	}
 
-	if (tmp_count > 0) {
-		uint32_t samples_per_sec = dps368_samples_per_sec(dps368_tmp_rate);
-		if (channel_start_packet(CHANNEL_TEMPERATURE, dps368_tmp_quant, timestamp,
-				 samples_per_sec, tmp_count)) {
-			for (int i = 0; i < tmp_count; i++) {
-				channel_add_packet_sample(tmp_buf[i]);
-			}
-			channel_finish_packet();
+	if (channel_start_packet(&dps368_writer, timestamp, section_count, prs_count + tmp_count)) {
+		if (prs_count > 0) {
+			channel_start_section(&dps368_writer, CHANNEL_PRESSURE, dps368_prs_quant,
+					      dps368_prs_pred,
+					      dps368_samples_per_sec(dps368_prs_rate));
+			channel_add_packet_samples(&dps368_writer, prs_buf, prs_count, 1);
+		}
+
+		if (tmp_count > 0) {
+			channel_start_section(&dps368_writer, CHANNEL_TEMPERATURE, dps368_tmp_quant,
+					      dps368_tmp_pred,
+					      dps368_samples_per_sec(dps368_tmp_rate));
+			channel_add_packet_samples(&dps368_writer, tmp_buf, tmp_count, 1);
 		}
+
+		channel_finish_packet(&dps368_writer);
 	}
+	return prs_count + tmp_count;
 }
 
-K_THREAD_STACK_DEFINE(dps368_thread_stack, 1024);
-struct k_thread dps368_thread;
-
-static void dps368_thread_main(void *, void *, void *)
+// Pressure and temperature measurements share one sensor, so when their oversampled
+// measurement times add up to more than a second per second, both rates drop in proportion.
+static uint32_t dps368_fill_rate(void)
 {
-	while (1) {
-		uint32_t prs_samples_per_sec = dps368_samples_per_sec(dps368_prs_rate);
-		uint32_t tmp_samples_per_sec = dps368_samples_per_sec(dps368_tmp_rate);
-		uint32_t sleep_usec =
-			dps368_watermark * 1000000 / (prs_samples_per_sec + tmp_samples_per_sec);
-		// LOG_INF("sleep_usec: %d", sleep_usec);
-		k_usleep(sleep_usec);
-
-		dps368_read_fifo();
+	uint32_t prs_samples_per_sec = dps368_samples_per_sec(dps368_prs_rate);
+	uint32_t tmp_samples_per_sec = dps368_samples_per_sec(dps368_tmp_rate);
+	uint32_t busy = prs_samples_per_sec * dps368_osr_time_table[dps368_prs_osr] +
+			tmp_samples_per_sec * dps368_osr_time_table[dps368_tmp_osr];
+	uint32_t rate = (prs_samples_per_sec + tmp_samples_per_sec) * 1000;
+
+	if (busy > 10000) {
+		rate = (uint64_t)rate * 10000 / busy;
 	}
+	return rate;
 }
 
+// Runs on the scheduler thread once it is up, see sched_reconfigure().
+static void dps368_config(void)
+{
+	dps368_prs_rate = dps368_request.prs_rate;
+	dps368_tmp_rate = dps368_request.tmp_rate;
+	dps368_prs_osr = dps368_request.prs_osr;
+	dps368_tmp_osr = dps368_request.tmp_osr;
+
+	uint8_t tmpcfg = dps368_tmp_osr | (dps368_tmp_rate << 4) | DPS368_REG_TMP_CFG_TMP_EXT;
+	uint8_t prscfg = dps368_prs_osr | (dps368_prs_rate << 4);
+	uint8_t cfg_reg = DPS368_REG_CFG_REG_FIFO_EN;
+	uint8_t meas_cfg = DPS368_REG_MEAS_CFG_MEAS_CTRL_CONT_BOTH;
+
+	spi_write_uint8(&dps368, DPS368_REG_TMP_CFG, tmpcfg);
+	spi_write_uint8(&dps368, DPS368_REG_PRS_CFG, prscfg);
+	spi_write_uint8(&dps368, DPS368_REG_CFG_REG, cfg_reg);
+	spi_write_uint8(&dps368, DPS368_REG_MEAS_CFG, meas_cfg);
+}
+
+struct sched_sensor dps368_sensor = {
+	.name = "dps368",
+	.fill_rate = dps368_fill_rate,
+	.service = dps368_read_fifo,
+	.config = dps368_config,
+	.depth = DPS368_FIFO_SIZE,
+};
+
 static void dps368_read_coefs(void)
 {
-	uint8_t coef[18];
-	for (int i = 0; i < 18; i++) {
-		coef[i] = spi_read_uint8(&dps368, DPS368_REG_COEF + i);
+	uint8_t coef[DPS368_COEF_LEN];
+	if (spi_read_buf(&dps368, DPS368_REG_COEF, sizeof(coef), coef) < 0) {
+		LOG_ERR("coefficient read failed");
+		return;
 	}
-	// spi_read_buf(&dps368, DPS368_REG_COEF, 18, coef);
 
 	c0Half = twoc(((uint32_t)coef[0] << 4) | (((uint32_t)coef[1] >> 4) & 0x0F), 12) / 2;
 	c1 = twoc((((uint32_t)coef[1] & 0x0F) << 8) | (uint32_t)coef[2], 12);
@@ -230,19 +306,6 @@ static void dps368_read_coefs(void)
 	LOG_INF("c01: %f c11: %f c21: %f", (double)c01, (double)c11, (double)c21);
 }
 
-static void dps368_config(void)
-{
-	uint8_t tmpcfg = dps368_tmp_osr | (dps368_tmp_rate << 4) | DPS368_REG_TMP_CFG_TMP_EXT;
-	uint8_t prscfg = dps368_prs_osr | (dps368_prs_rate << 4);
-	uint8_t cfg_reg = DPS368_REG_CFG_REG_FIFO_EN;
-	uint8_t meas_cfg = DPS368_REG_MEAS_CFG_MEAS_CTRL_CONT_BOTH;
-
-	spi_write_uint8(&dps368, DPS368_REG_TMP_CFG, tmpcfg);
-	spi_write_uint8(&dps368, DPS368_REG_PRS_CFG, prscfg);
-	spi_write_uint8(&dps368, DPS368_REG_CFG_REG, cfg_reg);
-	spi_write_uint8(&dps368, DPS368_REG_MEAS_CFG, meas_cfg);
-}
-
 void dps368_init(void)
 {
 	uint8_t id = spi_read_uint8(&dps368, DPS368_REG_PRODUCT_ID);
@@ -254,9 +317,8 @@ void dps368_init(void)
 	dps368_read_coefs();
 	dps368_config();
 
-	k_thread_create(&dps368_thread, dps368_thread_stack,
-			K_THREAD_STACK_SIZEOF(dps368_thread_stack), dps368_thread_main, NULL, NULL,
-			NULL, 7, 0, K_NO_WAIT);
+	dps368_sensor.watermark = dps368_watermark;
+	sched_register(&dps368_sensor);
 
 	LOG_INF("initialized");
 }
@@ -267,10 +329,9 @@ void dps368_latest(float *temperature, float *pressure)
 	*pressure = dps368_latest_prs_comp;
 }
 
+// The scheduler has to be stopped first, so the FIFO isn't drained mid-shutdown.
 void dps368_stop(void)
 {
-	k_thread_abort(&dps368_thread);
-
 	spi_write_uint8(&dps368, DPS368_REG_TMP_CFG, 0);
 	spi_write_uint8(&dps368, DPS368_REG_PRS_CFG, 0);
 	spi_write_uint8(&dps368, DPS368_REG_CFG_REG, 0);
@@ -292,8 +353,8 @@ static int cmd_dps368_tmp_rate(const struct shell *shell, size_t argc, char *arg
 	if (index < 0) {
 		return -1;
 	}
-	dps368_tmp_rate = (enum dps368_rate)index;
-	dps368_config();
+	dps368_request.tmp_rate = (enum dps368_rate)index;
+	sched_reconfigure(&dps368_sensor);
 	return 0;
 }
 
@@ -304,8 +365,8 @@ static int cmd_dps368_prs_rate(const struct shell *shell, size_t argc, char *arg
 	if (index < 0) {
 		return -1;
 	}
-	dps368_prs_rate = (enum dps368_rate)index;
-	dps368_config();
+	dps368_request.prs_rate = (enum dps368_rate)index;
+	sched_reconfigure(&dps368_sensor);
 	return 0;
 }
 
@@ -316,8 +377,8 @@ static int cmd_dps368_tmp_osr(const struct shell *shell, size_t argc, char *argv
 	if (index < 0) {
 		return -1;
 	}
-	dps368_tmp_osr = (enum dps368_oversampling)index;
-	dps368_config();
+	dps368_request.tmp_osr = (enum dps368_oversampling)index;
+	sched_reconfigure(&dps368_sensor);
 	return 0;
 }
 
@@ -328,14 +389,14 @@ static int cmd_dps368_prs_osr(const struct shell *shell, size_t argc, char *argv
 	if (index < 0) {
 		return -1;
 	}
-	dps368_prs_osr = (enum dps368_oversampling)index;
-	dps368_config();
+	dps368_request.prs_osr = (enum dps368_oversampling)index;
+	sched_reconfigure(&dps368_sensor);
 	return 0;
 }
 
 static int cmd_dps368_tmp_quant(const struct shell *shell, size_t argc, char *argv[])
 {
-	int index = cmd_table_lookup(shell, quantize_names, QUANTIZE_COUNT, argv[1]);
+	int index = cmd_table_lookup(shell, quantize_names, QUANTIZE_RAW, argv[1]);
 	if (index < 0) {
 		return -1;
 	}
@@ -345,7 +406,7 @@ static int cmd_dps368_tmp_quant(const struct shell *shell, size_t argc, char *ar
 
 static int cmd_dps368_prs_quant(const struct shell *shell, size_t argc, char *argv[])
 {
-	int index = cmd_table_lookup(shell, quantize_names, QUANTIZE_COUNT, argv[1]);
+	int index = cmd_table_lookup(shell, quantize_names, QUANTIZE_RAW, argv[1]);
 	if (index < 0) {
 		return -1;
 	}
@@ -353,6 +414,26 @@ static int cmd_dps368_prs_quant(const struct shell *shell, size_t argc, char *ar
 	return 0;
 }
 
+static int cmd_dps368_tmp_pred(const struct shell *shell, size_t argc, char *argv[])
+{
+	int index = cmd_table_lookup(shell, predictor_names, PREDICTOR_COUNT, argv[1]);
+	if (index < 0) {
+		return -1;
+	}
+	dps368_tmp_pred = (enum predictor)index;
+	return 0;
+}
+
+static int cmd_dps368_prs_pred(const struct shell *shell, size_t argc, char *argv[])
+{
+	int index = cmd_table_lookup(shell, predictor_names, PREDICTOR_COUNT, argv[1]);
+	if (index < 0) {
+		return -1;
+	}
+	dps368_prs_pred = (enum predictor)index;
+	return 0;
+}
+
 static int cmd_dps368_status(const struct shell *shell, size_t argc, char *argv[])
 {
 	shell_fprintf(shell, SHELL_NORMAL, "DPS368 status:\n");
@@ -360,6 +441,16 @@ static int cmd_dps368_status(const struct shell *shell, size_t argc, char *argv[
 	shell_fprintf(shell, SHELL_NORMAL, " prs_rate: %s\n", dps368_rate_names[dps368_prs_rate]);
 	shell_fprintf(shell, SHELL_NORMAL, " tmp_osr: %s\n", dps368_osr_names[dps368_tmp_osr]);
 	shell_fprintf(shell, SHELL_NORMAL, " prs_osr: %s\n", dps368_osr_names[dps368_prs_osr]);
+	shell_fprintf(shell, SHELL_NORMAL, " tmp_pred: %s\n", predictor_names[dps368_tmp_pred]);
+	shell_fprintf(shell, SHELL_NORMAL, " prs_pred: %s\n", predictor_names[dps368_prs_pred]);
+
+	// Byte-at-a-time reads took three transactions for every entry and every empty marker.
+	uint32_t reads = dps368_fifo_entries + dps368_fifo_drains;
+	shell_fprintf(shell, SHELL_NORMAL,
+		      " fifo: %u drains, %u entries, %u spi transactions (%u with byte reads)\n",
+		      dps368_fifo_drains, dps368_fifo_entries, dps368_fifo_transactions,
+		      reads * DPS368_FIFO_ENTRY_LEN);
+	shell_fprintf(shell, SHELL_NORMAL, " spi: %u transactions total\n", spi_transactions);
 	return 0;
 }
 
@@ -373,6 +464,8 @@ SHELL_STATIC_SUBCMD_SET_CREATE(
 	SHELL_CMD_ARG(prs_osr, NULL, "1|2|4|8|16|32|64|128", cmd_dps368_prs_osr, 2, 0),
 	SHELL_CMD_ARG(tmp_quant, NULL, QUANTIZE_HELP, cmd_dps368_tmp_quant, 2, 0),
 	SHELL_CMD_ARG(prs_quant, NULL, QUANTIZE_HELP, cmd_dps368_prs_quant, 2, 0),
+	SHELL_CMD_ARG(tmp_pred, NULL, PREDICTOR_HELP, cmd_dps368_tmp_pred, 2, 0),
+	SHELL_CMD_ARG(prs_pred, NULL, PREDICTOR_HELP, cmd_dps368_prs_pred, 2, 0),
 	SHELL_CMD_ARG(status, NULL, "print device status", cmd_dps368_status, 1, 0),
 	SHELL_SUBCMD_SET_END);
 
@@ -0,0 +1,399 @@
+#define DT_DRV_COMPAT kartcam_dps368_spi
+
+#include "common.h"
+
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/spi_emul.h>
+
+LOG_MODULE_REGISTER(dps368_emul);
+
+// DPS368 on the native_sim SPI emulator bus. It models what dps368.c relies on: the product ID,
+// the calibration coefficient block, continuous pressure and temperature measurements at the
+// configured rates and oversampling, and the 32 entry FIFO that reading PRS_B0 pops. Measured
+// values come from the shared waveform (see emul.c) and are turned back into raw readings
+// through the coefficients, so the firmware's compensation gets the waveform back.
+
+#define DPS368_REG_PRS_B2           0x00
+#define DPS368_REG_PRS_B0           0x02
+#define DPS368_REG_TMP_B2           0x03
+#define DPS368_REG_TMP_B0           0x05
+#define DPS368_REG_PRS_CFG          0x06
+#define DPS368_REG_TMP_CFG          0x07
+#define DPS368_REG_MEAS_CFG         0x08
+#define DPS368_REG_CFG_REG          0x09
+#define DPS368_REG_CFG_REG_FIFO_EN  0x02
+#define DPS368_REG_FIFO_STS         0x0B
+#define DPS368_REG_RESET            0x0C
+#define DPS368_REG_RESET_FIFO_FLUSH BIT(7)
+#define DPS368_REG_RESET_SOFT_RST   0x09
+#define DPS368_REG_PRODUCT_ID       0x0D
+#define DPS368_REG_COEF             0x10
+#define DPS368_REG_COEF_SRCE        0x28
+#define DPS368_REG_COUNT            0x29
+#define DPS368_COEF_LEN             18
+
+#define DPS368_FIFO_SIZE  32
+#define DPS368_FIFO_EMPTY 0x800000
+
+enum dps368_emul_meas {
+	DPS368_EMUL_IDLE,
+	DPS368_EMUL_CMD_PRS,
+	DPS368_EMUL_CMD_TMP,
+	DPS368_EMUL_CONT_PRS = 5,
+	DPS368_EMUL_CONT_TMP,
+	DPS368_EMUL_CONT_BOTH,
+};
+
+struct dps368_emul_data {
+	struct k_spinlock lock;
+	uint8_t regs[DPS368_REG_COUNT];
+
+	// Measurement clocks: measurement n is taken at start_us + (n + 1) * period.
+	uint64_t start_us;
+	uint64_t prs_period_ns;
+	uint64_t tmp_period_ns;
+	uint64_t prs_next;
+	uint64_t tmp_next;
+
+	uint32_t fifo[DPS368_FIFO_SIZE];
+	uint8_t head;
+	uint8_t level;
+	uint32_t prs_result;
+	uint32_t tmp_result;
+	uint8_t ready;
+	float tmp_sc;
+
+	// The burst in progress.
+	uint8_t addr;
+	bool read;
+
+	uint32_t measurements;
+	uint32_t dropped;
+	uint32_t entries;
+};
+
+static struct dps368_emul_data *dps368_emul;
+
+// Typical calibration, in the widths the coefficient block packs them to.
+#define DPS368_EMUL_C0  204
+#define DPS368_EMUL_C1  (-261)
+#define DPS368_EMUL_C00 80469
+#define DPS368_EMUL_C10 (-54769)
+#define DPS368_EMUL_C01 (-2419)
+#define DPS368_EMUL_C11 1430
+#define DPS368_EMUL_C20 (-9826)
+#define DPS368_EMUL_C21 186
+#define DPS368_EMUL_C30 (-1000)
+
+static const float dps368_emul_scaling_facts[] = {524288.0f, 1572864.0f, 3670016.0f,
+						  7864320.0f, 253952.0f,  516096.0f,
+						  1040384.0f, 2088960.0f};
+
+// Measurement times in 0.1 ms per oversampling rate, from the datasheet.
+static const uint16_t dps368_emul_osr_time[] = {36, 52, 84, 148, 276, 532, 1044, 2068};
+
+static void dps368_emul_pack_coefs(uint8_t *coef)
+{
+	uint32_t c0 = DPS368_EMUL_C0 & 0xFFF, c1 = DPS368_EMUL_C1 & 0xFFF;
+	uint32_t c00 = DPS368_EMUL_C00 & 0xFFFFF, c10 = DPS368_EMUL_C10 & 0xFFFFF;
+	const int32_t c16[] = {DPS368_EMUL_C01, DPS368_EMUL_C11, DPS368_EMUL_C20, DPS368_EMUL_C21,
+			       DPS368_EMUL_C30};
+
+	coef[0] = c0 >> 4;
+	coef[1] = (c0 & 0x0F) << 4 | c1 >> 8;
+	coef[2] = c1;
+	coef[3] = c00 >> 12;
+	coef[4] = c00 >> 4;
+	coef[5] = (c00 & 0x0F) << 4 | c10 >> 16;
+	coef[6] = c10 >> 8;
+	coef[7] = c10;
+	for (size_t i = 0; i < ARRAY_SIZE(c16); i++) {
+		coef[8 + 2 * i] = (uint16_t)c16[i] >> 8;
+		coef[9 + 2 * i] = c16[i];
+	}
+}
+
+// A raw reading as a 24 bit word, with the FIFO's type flag in bit 0: 1 for pressure.
+static uint32_t dps368_emul_raw(double scaled, uint8_t osr, bool pressure)
+{
+	double raw = round(scaled * dps368_emul_scaling_facts[osr]);
+
+	raw = CLAMP(raw, -(1 << 23), (1 << 23) - 1);
+	return ((uint32_t)(int32_t)raw & 0xFFFFFE) | pressure;
+}
+
+// Inverts the compensation formula for the scaled pressure reading, with a few Newton steps
+// from its linear part.
+static double dps368_emul_prs_sc(double pressure, double t)
+{
+	double c10 = DPS368_EMUL_C10 + t * DPS368_EMUL_C11;
+	double x = (pressure - DPS368_EMUL_C00 - t * DPS368_EMUL_C01) / c10;
+
+	for (int i = 0; i < 4; i++) {
+		double f = DPS368_EMUL_C00 + x * (DPS368_EMUL_C10 + x * (DPS368_EMUL_C20 +
+									 x * DPS368_EMUL_C30)) +
+			   t * (DPS368_EMUL_C01 + x * (DPS368_EMUL_C11 + x * DPS368_EMUL_C21)) -
+			   pressure;
+		double df = DPS368_EMUL_C10 + x * (2 * DPS368_EMUL_C20 + 3 * x * DPS368_EMUL_C30) +
+			    t * (DPS368_EMUL_C11 + 2 * x * DPS368_EMUL_C21);
+		x -= f / df;
+	}
+	return x;
+}
+
+static void dps368_emul_measure(struct dps368_emul_data *data, uint64_t t_us, bool pressure)
+{
+	struct emul_frame f;
+	uint32_t entry;
+
+	emul_frame(t_us, &f);
+	if (pressure) {
+		uint8_t osr = data->regs[DPS368_REG_PRS_CFG] & 0x7;
+
+		entry = dps368_emul_raw(dps368_emul_prs_sc(f.pressure, data->tmp_sc), osr, true);
+		data->prs_result = entry;
+	} else {
+		uint8_t osr = data->regs[DPS368_REG_TMP_CFG] & 0x7;
+		// The firmware halves c0 in integer arithmetic, so the same is done here.
+		double tmp_sc = (f.temperature - DPS368_EMUL_C0 / 2) / (double)DPS368_EMUL_C1;
+
+		entry = dps368_emul_raw(tmp_sc, osr, false);
+		// Pressure is compensated with the temperature as read back.
+		data->tmp_sc = (float)((int32_t)(entry << 8) >> 8) / dps368_emul_scaling_facts[osr];
+		data->tmp_result = entry;
+	}
+	data->measurements++;
+
+	if (!(data->regs[DPS368_REG_CFG_REG] & DPS368_REG_CFG_REG_FIFO_EN)) {
+		return;
+	}
+	if (data->level == DPS368_FIFO_SIZE) {
+		data->dropped++;
+		return;
+	}
+	data->fifo[(data->head + data->level) % DPS368_FIFO_SIZE] = entry;
+	data->level++;
+}
+
+// Pressure and temperature measurements share one sensor, so when their oversampled
+// measurement times add up to more than a second per second, both rates drop in proportion.
+static void dps368_emul_start(struct dps368_emul_data *data, uint64_t now)
+{
+	uint8_t meas = data->regs[DPS368_REG_MEAS_CFG] & 0x7;
+	uint8_t prs_cfg = data->regs[DPS368_REG_PRS_CFG];
+	uint8_t tmp_cfg = data->regs[DPS368_REG_TMP_CFG];
+	bool prs = meas == DPS368_EMUL_CONT_PRS || meas == DPS368_EMUL_CONT_BOTH;
+	bool tmp = meas == DPS368_EMUL_CONT_TMP || meas == DPS368_EMUL_CONT_BOTH;
+	uint32_t prs_rate = 1 << ((prs_cfg >> 4) & 0x7);
+	uint32_t tmp_rate = 1 << ((tmp_cfg >> 4) & 0x7);
+	uint32_t busy = (prs ? prs_rate * dps368_emul_osr_time[prs_cfg & 0x7] : 0) +
+			(tmp ? tmp_rate * dps368_emul_osr_time[tmp_cfg & 0x7] : 0);
+	uint64_t stretch = MAX(busy, 10000);
+
+	data->start_us = now;
+	data->prs_next = 0;
+	data->tmp_next = 0;
+	data->prs_period_ns = prs ? 1000000000ull * stretch / (10000ull * prs_rate) : 0;
+	data->tmp_period_ns = tmp ? 1000000000ull * stretch / (10000ull * tmp_rate) : 0;
+
+	// Command mode takes one measurement and goes back to idle.
+	if (meas == DPS368_EMUL_CMD_PRS || meas == DPS368_EMUL_CMD_TMP) {
+		dps368_emul_measure(data, now, meas == DPS368_EMUL_CMD_PRS);
+		data->ready |= meas == DPS368_EMUL_CMD_PRS ? BIT(4) : BIT(5);
+		data->regs[DPS368_REG_MEAS_CFG] &= ~0x7;
+	}
+}
+
+static uint64_t dps368_emul_due(uint64_t elapsed_us, uint64_t period_ns)
+{
+	return period_ns ? elapsed_us * 1000 / period_ns : 0;
+}
+
+// Takes every measurement due by now, in time order, temperature first on a tie so pressure is
+// compensated with it. Once the FIFO is full the rest are only counted.
+static void dps368_emul_sample(struct dps368_emul_data *data, uint64_t now)
+{
+	if (now < data->start_us) {
+		return;
+	}
+
+	uint64_t prs_due = dps368_emul_due(now - data->start_us, data->prs_period_ns);
+	uint64_t tmp_due = dps368_emul_due(now - data->start_us, data->tmp_period_ns);
+	bool fifo = data->regs[DPS368_REG_CFG_REG] & DPS368_REG_CFG_REG_FIFO_EN;
+	uint64_t start = data->start_us;
+
+	while (data->prs_next < prs_due || data->tmp_next < tmp_due) {
+		if (!fifo || data->level == DPS368_FIFO_SIZE) {
+			// Only the last of each can still be seen, in the result registers.
+			uint64_t prs_skip = MAX(prs_due, data->prs_next + 1) - data->prs_next - 1;
+			uint64_t tmp_skip = MAX(tmp_due, data->tmp_next + 1) - data->tmp_next - 1;
+
+			data->prs_next += prs_skip;
+			data->tmp_next += tmp_skip;
+			data->measurements += prs_skip + tmp_skip;
+			data->dropped += fifo ? prs_skip + tmp_skip : 0;
+		}
+
+		uint64_t prs_at = start + (data->prs_next + 1) * data->prs_period_ns / 1000;
+		uint64_t tmp_at = start + (data->tmp_next + 1) * data->tmp_period_ns / 1000;
+		bool pressure = data->tmp_next >= tmp_due ||
+				(data->prs_next < prs_due && prs_at < tmp_at);
+
+		if (pressure) {
+			data->prs_next++;
+			dps368_emul_measure(data, prs_at, true);
+		} else {
+			data->tmp_next++;
+			dps368_emul_measure(data, tmp_at, false);
+		}
+	}
+}
+
+static void dps368_emul_flush(struct dps368_emul_data *data)
+{
+	data->head = 0;
+	data->level = 0;
+}
+
+static uint8_t dps368_emul_read(struct dps368_emul_data *data, uint8_t addr)
+{
+	bool fifo = data->regs[DPS368_REG_CFG_REG] & DPS368_REG_CFG_REG_FIFO_EN;
+
+	switch (addr) {
+	case DPS368_REG_PRS_B2 ... DPS368_REG_PRS_B0: {
+		// With the FIFO on, the pressure registers show its oldest entry, and reading the
+		// last byte of it pops it.
+		uint32_t entry = fifo ? (data->level ? data->fifo[data->head] : DPS368_FIFO_EMPTY)
+				      : data->prs_result;
+
+		if (addr == DPS368_REG_PRS_B0 && fifo && data->level) {
+			data->head = (data->head + 1) % DPS368_FIFO_SIZE;
+			data->level--;
+			data->entries++;
+		}
+		if (addr == DPS368_REG_PRS_B0) {
+			data->ready &= ~BIT(4);
+		}
+		return entry >> (8 * (DPS368_REG_PRS_B0 - addr));
+	}
+	case DPS368_REG_TMP_B2 ... DPS368_REG_TMP_B0:
+		if (addr == DPS368_REG_TMP_B0) {
+			data->ready &= ~BIT(5);
+		}
+		return data->tmp_result >> (8 * (DPS368_REG_TMP_B0 - addr));
+	case DPS368_REG_MEAS_CFG:
+		// Coefficients and sensor are always ready.
+		return BIT(7) | BIT(6) | data->ready | (data->regs[addr] & 0x7);
+	case DPS368_REG_FIFO_STS:
+		return (data->level == DPS368_FIFO_SIZE ? BIT(1) : 0) | (data->level ? 0 : BIT(0));
+	case DPS368_REG_PRODUCT_ID:
+		return 0x10;
+	case DPS368_REG_COEF_SRCE:
+		return BIT(7);
+	default:
+		return addr < DPS368_REG_COUNT ? data->regs[addr] : 0;
+	}
+}
+
+static void dps368_emul_write(struct dps368_emul_data *data, uint8_t addr, uint8_t value,
+			      uint64_t now)
+{
+	switch (addr) {
+	case DPS368_REG_PRS_CFG:
+	case DPS368_REG_TMP_CFG:
+	case DPS368_REG_CFG_REG:
+		data->regs[addr] = value;
+		if (!(data->regs[DPS368_REG_CFG_REG] & DPS368_REG_CFG_REG_FIFO_EN)) {
+			dps368_emul_flush(data);
+		}
+		break;
+	case DPS368_REG_MEAS_CFG:
+		data->regs[addr] = value & 0x7;
+		dps368_emul_start(data, now);
+		break;
+	case DPS368_REG_RESET:
+		if (value & DPS368_REG_RESET_FIFO_FLUSH) {
+			dps368_emul_flush(data);
+		}
+		if ((value & 0x0F) == DPS368_REG_RESET_SOFT_RST) {
+			memset(data->regs, 0, DPS368_REG_COEF);
+			dps368_emul_flush(data);
+			dps368_emul_start(data, now);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+// The address always auto-increments.
+static uint8_t dps368_emul_xfer(void *ctx, size_t pos, uint8_t mosi)
+{
+	struct dps368_emul_data *data = ctx;
+	uint8_t miso = 0;
+
+	if (pos == 0) {
+		data->addr = mosi & 0x7F;
+		data->read = mosi & 0x80;
+		return 0xFF;
+	}
+
+	if (data->read) {
+		miso = dps368_emul_read(data, data->addr);
+	} else {
+		dps368_emul_write(data, data->addr, mosi, emul_time_us());
+	}
+	data->addr = (data->addr + 1) & 0x7F;
+	return miso;
+}
+
+static int dps368_emul_io(const struct emul *target, const struct spi_config *config,
+			  const struct spi_buf_set *tx_bufs, const struct spi_buf_set *rx_bufs)
+{
+	struct dps368_emul_data *data = target->data;
+
+	k_spinlock_key_t key = k_spin_lock(&data->lock);
+	dps368_emul_sample(data, emul_time_us());
+	emul_spi_io(tx_bufs, rx_bufs, dps368_emul_xfer, data);
+	k_spin_unlock(&data->lock, key);
+	return 0;
+}
+
+static const struct spi_emul_api dps368_emul_api = {
+	.io = dps368_emul_io,
+};
+
+static int dps368_emul_init(const struct emul *target, const struct device *parent)
+{
+	struct dps368_emul_data *data = target->data;
+
+	dps368_emul_pack_coefs(&data->regs[DPS368_REG_COEF]);
+	dps368_emul = data;
+	return 0;
+}
+
+void dps368_emul_status(const struct shell *shell)
+{
+	struct dps368_emul_data *data = dps368_emul;
+
+	if (data == NULL) {
+		return;
+	}
+
+	k_spinlock_key_t key = k_spin_lock(&data->lock);
+	shell_fprintf(shell, SHELL_NORMAL,
+		      " dps368: meas=%u fifo=%u measurements=%u read=%u dropped=%u\n",
+		      data->regs[DPS368_REG_MEAS_CFG] & 0x7, data->level, data->measurements,
+		      data->entries, data->dropped);
+	k_spin_unlock(&data->lock, key);
+}
+
+// As for the LIS3DH, an empty device stands in for the driver the emulator framework expects.
+#define DPS368_EMUL(n)                                                                             \
+	static struct dps368_emul_data dps368_emul_data_##n;                                       \
+	EMUL_DT_INST_DEFINE(n, dps368_emul_init, &dps368_emul_data_##n, NULL, &dps368_emul_api,    \
+			    NULL);                                                                 \
+	DEVICE_DT_INST_DEFINE(n, NULL, NULL, NULL, NULL, POST_KERNEL,                              \
+			      CONFIG_KERNEL_INIT_PRIORITY_DEVICE, NULL);
+
+DT_INST_FOREACH_STATUS_OKAY(DPS368_EMUL)
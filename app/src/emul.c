@@ -0,0 +1,156 @@
+#include "common.h"
+
+LOG_MODULE_REGISTER(emul);
+
+// The native_sim sensor emulators (lis3dh_emul.c, dps368_emul.c) sample one shared waveform, so
+// acceleration and pressure stay in step. A waveform is a list of keyframes, interpolated
+// linearly and looped, with vibration and noise added on top. Everything is a function of the
+// sample's own time, so a run replays identically however the firmware polls the sensors.
+
+struct emul_keyframe {
+	uint32_t t_ms;
+	int16_t accel[3]; // mg
+	int16_t vib_mg;
+	int16_t vib_hz;
+	int32_t pressure; // Pa
+	int16_t temperature; // 0.01 degC
+};
+
+struct emul_waveform {
+	const char *name;
+	const struct emul_keyframe *keyframes;
+	size_t count;
+};
+
+#include "emul_waveforms.h"
+
+#define EMUL_ACCEL_NOISE       6.0f  // mg
+#define EMUL_PRESSURE_NOISE    2.0f  // Pa
+#define EMUL_TEMPERATURE_NOISE 0.02f // degC
+
+// Vibration is strongest vertically; the other axes see it at other frequencies.
+static const float emul_vib_gain[3] = {0.5f, 0.35f, 1.0f};
+static const float emul_vib_freq[3] = {1.9f, 2.7f, 1.0f};
+
+static const struct emul_waveform *emul_waveform = &emul_waveforms[0];
+static uint64_t emul_epoch_us;
+
+uint64_t emul_time_us(void)
+{
+	return k_ticks_to_us_floor64(k_uptime_ticks());
+}
+
+// Uniform noise in [-1, 1) that depends only on the time and the signal.
+static float emul_noise(uint64_t t_us, uint32_t signal)
+{
+	uint32_t x = (uint32_t)t_us * 0x9E3779B1u ^ (uint32_t)(t_us >> 32) ^ signal * 0x85EBCA6Bu;
+
+	x ^= x >> 16;
+	x *= 0x7FEB352Du;
+	x ^= x >> 15;
+	x *= 0x846CA68Bu;
+	x ^= x >> 16;
+	return (float)x / 2147483648.0f - 1.0f;
+}
+
+void emul_frame(uint64_t t_us, struct emul_frame *f)
+{
+	const struct emul_waveform *w = emul_waveform;
+	uint64_t t = t_us > emul_epoch_us ? t_us - emul_epoch_us : 0;
+	uint32_t period_ms = w->keyframes[w->count - 1].t_ms;
+	uint32_t in_ms = (t / 1000) % period_ms;
+	size_t i = 0;
+
+	while (i + 2 < w->count && w->keyframes[i + 1].t_ms <= in_ms) {
+		i++;
+	}
+
+	const struct emul_keyframe *a = &w->keyframes[i];
+	const struct emul_keyframe *b = &w->keyframes[i + 1];
+	float u = ((in_ms - a->t_ms) + (t % 1000) / 1000.0f) / (b->t_ms - a->t_ms);
+	double seconds = t / 1000000.0;
+
+	for (int axis = 0; axis < 3; axis++) {
+		float base = a->accel[axis] + u * (b->accel[axis] - a->accel[axis]);
+		double phase = 2.0 * M_PI * a->vib_hz * emul_vib_freq[axis] * seconds;
+		float noise = emul_noise(t_us, axis) + emul_noise(t_us, axis + 8);
+
+		f->accel[axis] = base + a->vib_mg * emul_vib_gain[axis] * (float)sin(phase) +
+				 noise * EMUL_ACCEL_NOISE / 2;
+	}
+	f->pressure = a->pressure + u * (b->pressure - a->pressure) +
+		      emul_noise(t_us, 3) * EMUL_PRESSURE_NOISE;
+	f->temperature = (a->temperature + u * (b->temperature - a->temperature)) / 100.0f +
+			 emul_noise(t_us, 4) * EMUL_TEMPERATURE_NOISE;
+}
+
+static size_t emul_spi_len(const struct spi_buf_set *set)
+{
+	size_t len = 0;
+
+	for (size_t i = 0; set != NULL && i < set->count; i++) {
+		len += set->buffers[i].len;
+	}
+	return len;
+}
+
+// Returns byte pos of a buffer set, or NULL where its buffer is NULL or the set is shorter.
+static uint8_t *emul_spi_byte(const struct spi_buf_set *set, size_t pos)
+{
+	for (size_t i = 0; set != NULL && i < set->count; i++) {
+		if (pos < set->buffers[i].len) {
+			return set->buffers[i].buf ? (uint8_t *)set->buffers[i].buf + pos : NULL;
+		}
+		pos -= set->buffers[i].len;
+	}
+	return NULL;
+}
+
+void emul_spi_io(const struct spi_buf_set *tx, const struct spi_buf_set *rx,
+		 uint8_t (*xfer)(void *ctx, size_t pos, uint8_t mosi), void *ctx)
+{
+	size_t len = MAX(emul_spi_len(tx), emul_spi_len(rx));
+
+	for (size_t pos = 0; pos < len; pos++) {
+		uint8_t *out = emul_spi_byte(tx, pos);
+		uint8_t *in = emul_spi_byte(rx, pos);
+		uint8_t miso = xfer(ctx, pos, out ? *out : 0);
+
+		if (in) {
+			*in = miso;
+		}
+	}
+}
+
+static int cmd_emul_wave(const struct shell *shell, size_t argc, char *argv[])
+{
+	int index = cmd_table_lookup(shell, emul_waveform_names, ARRAY_SIZE(emul_waveform_names),
+				     argv[1]);
+	if (index < 0) {
+		return -1;
+	}
+	emul_waveform = &emul_waveforms[index];
+	emul_epoch_us = emul_time_us();
+	return 0;
+}
+
+static int cmd_emul_status(const struct shell *shell, size_t argc, char *argv[])
+{
+	const struct emul_waveform *w = emul_waveform;
+	uint32_t period_ms = w->keyframes[w->count - 1].t_ms;
+	uint32_t at_ms = (emul_time_us() - emul_epoch_us) / 1000 % period_ms;
+
+	shell_fprintf(shell, SHELL_NORMAL, "Emulator status:\n");
+	shell_fprintf(shell, SHELL_NORMAL, " wave: %s at %u of %u ms\n", w->name, at_ms, period_ms);
+	lis3dh_emul_status(shell);
+	dps368_emul_status(shell);
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(emul_cmds,
+			       SHELL_CMD_ARG(wave, NULL, EMUL_WAVEFORM_HELP, cmd_emul_wave, 2, 0),
+			       SHELL_CMD_ARG(status, NULL, "print emulator status", cmd_emul_status,
+					     1, 0),
+			       SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(emul, &emul_cmds, "Emulated sensors (native_sim)", NULL);
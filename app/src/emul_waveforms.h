@@ -0,0 +1,63 @@
+// Generated by scripts/plot/gen_waveforms.py from scripts/plot/waveforms/ - do not edit.
+
+#ifndef EMUL_WAVEFORMS_H
+#define EMUL_WAVEFORMS_H
+
+// Cornering: a left, a right and a hairpin whose lateral load goes past the 2g range, so
+// the sensor clips.
+static const struct emul_keyframe emul_cornering[] = {
+	{0, {0, 0, 1000}, 120, 30, 101325, 2500},
+	{1000, {-600, 0, 1000}, 100, 26, 101325, 2500},
+	{2000, {-200, 1200, 1050}, 100, 26, 101330, 2510},
+	{3500, {100, 1500, 1080}, 110, 28, 101335, 2510},
+	{5000, {300, 0, 1000}, 150, 34, 101330, 2510},
+	{7000, {0, -1400, 1060}, 140, 32, 101335, 2520},
+	{8500, {200, -1500, 1070}, 140, 32, 101340, 2520},
+	{9500, {300, 0, 1000}, 160, 36, 101335, 2520},
+	{12000, {-1000, 0, 1000}, 120, 28, 101330, 2520},
+	{13000, {-300, 1800, 1120}, 90, 22, 101340, 2530},
+	{14500, {0, 2100, 1150}, 80, 20, 101345, 2530},
+	{16000, {400, 600, 1020}, 120, 30, 101340, 2530},
+	{18000, {300, 0, 1000}, 160, 36, 101330, 2520},
+	{20000, {0, 0, 1000}, 120, 30, 101325, 2500},
+};
+
+// Pressure ramp: a tire warming up over a minute of laps, then bled back down so the file
+// loops. Kept inside the DPS368's 30-120 kPa range.
+static const struct emul_keyframe emul_pressure_ramp[] = {
+	{0, {0, 0, 1000}, 100, 30, 101325, 2200},
+	{10000, {0, 0, 1000}, 120, 32, 103000, 2600},
+	{30000, {0, 0, 1000}, 140, 34, 108500, 3400},
+	{50000, {0, 0, 1000}, 140, 34, 112500, 4000},
+	{56000, {0, 0, 1000}, 100, 30, 113000, 4100},
+	{60000, {0, 0, 1000}, 100, 30, 101325, 2200},
+};
+
+// Straight: out of a corner on the throttle, flat out, then hard braking. Engine and track
+// vibration rise with speed.
+static const struct emul_keyframe emul_straight[] = {
+	{0, {0, 0, 1000}, 80, 22, 101325, 2500},
+	{1500, {350, 0, 1000}, 110, 28, 101325, 2500},
+	{6000, {250, 0, 1000}, 160, 36, 101330, 2500},
+	{12000, {80, 0, 1000}, 200, 42, 101330, 2510},
+	{14000, {-900, 0, 1000}, 150, 34, 101325, 2510},
+	{16000, {-900, 0, 1000}, 120, 28, 101325, 2510},
+	{17000, {0, 0, 1000}, 90, 24, 101325, 2510},
+	{20000, {0, 0, 1000}, 80, 22, 101325, 2500},
+};
+
+static const struct emul_waveform emul_waveforms[] = {
+	{"cornering", emul_cornering, ARRAY_SIZE(emul_cornering)},
+	{"pressure_ramp", emul_pressure_ramp, ARRAY_SIZE(emul_pressure_ramp)},
+	{"straight", emul_straight, ARRAY_SIZE(emul_straight)},
+};
+
+static const char *emul_waveform_names[] = {
+	"cornering",
+	"pressure_ramp",
+	"straight",
+};
+
+#define EMUL_WAVEFORM_HELP "cornering|pressure_ramp|straight"
+
+#endif
@@ -0,0 +1,324 @@
+#include "common.h"
+
+LOG_MODULE_REGISTER(energy);
+
+//
+// Charge estimate for a recording, from counters kept where the work happens: thread wakeups,
+// SPI transactions and bytes per device, flash writes and erases, radio-on time, DPS368
+// measuring time and, with CONFIG_APP_ENERGY_CPU, CPU time from the kernel's thread usage. Each
+// is multiplied by a per operation charge or a current from energy_params, which default to
+// datasheet figures for the nRF52832 (DC/DC on), LIS3DH and DPS368 and can be changed from the
+// shell to match a bench measurement. Everything is counted from the last energy_mark(), which
+// recorder_start() calls, and scaled to uAh per minute, so settings such as rates, watermarks and
+// oversampling can be compared by the battery life they project.
+//
+// Currents are in nA and charges in pC: nA times ms and pC are the same unit.
+//
+#define ENERGY_PC_PER_UAH 3600000000.0
+
+enum energy_param_id
+{
+    ENERGY_NRF_IDLE,
+    ENERGY_NRF_RUN,
+    ENERGY_NRF_WAKEUP,
+    ENERGY_NRF_OFF,
+    ENERGY_SPI_XFER,
+    ENERGY_SPI_BYTE,
+    ENERGY_FLASH_BYTE,
+    ENERGY_FLASH_ERASE,
+    ENERGY_RADIO,
+    ENERGY_LIS3DH_IDLE,
+    ENERGY_LIS3DH_SAMPLE,
+    ENERGY_LIS3DH_LP_SAMPLE,
+    ENERGY_DPS368_IDLE,
+    ENERGY_DPS368_MEASURE,
+    ENERGY_BATTERY,
+    ENERGY_PARAM_COUNT
+};
+
+struct energy_param {
+	const char *name;
+	const char *unit;
+	uint32_t value;
+};
+
+static struct energy_param energy_params[ENERGY_PARAM_COUNT] = {
+	// System ON with RTC and RAM retained, plus the 32 kHz crystal.
+	[ENERGY_NRF_IDLE] = {"nrf_idle", "nA", 1900},
+	// CPU running from flash at 64 MHz, on top of idle.
+	[ENERGY_NRF_RUN] = {"nrf_run", "nA", 3700000},
+	// HFCLK and regulator start-up per thread wakeup, beyond the CPU time it runs.
+	[ENERGY_NRF_WAKEUP] = {"nrf_wakeup", "pC", 20000},
+	// System OFF with a GPIO wake source.
+	[ENERGY_NRF_OFF] = {"nrf_off", "nA", 400},
+	// SPIM and EasyDMA per transaction and per byte at 8 MHz.
+	[ENERGY_SPI_XFER] = {"spi_xfer", "pC", 5500},
+	[ENERGY_SPI_BYTE] = {"spi_byte", "pC", 1100},
+	// 41 us at 7.5 mA per 4 byte word, 85 ms at 6.5 mA per page erase.
+	[ENERGY_FLASH_BYTE] = {"flash_byte", "pC", 77000},
+	[ENERGY_FLASH_ERASE] = {"flash_erase", "pC", 552000000},
+	// TX at 0 dBm and RX average.
+	[ENERGY_RADIO] = {"radio", "nA", 7000000},
+	// Power-down current, and per sample over it, fitted to the 100 to 400 Hz figures.
+	[ENERGY_LIS3DH_IDLE] = {"lis3dh_idle", "nA", 500},
+	[ENERGY_LIS3DH_SAMPLE] = {"lis3dh_sample", "pC", 185000},
+	[ENERGY_LIS3DH_LP_SAMPLE] = {"lis3dh_lp_sample", "pC", 90000},
+	// Standby, and while a measurement runs.
+	[ENERGY_DPS368_IDLE] = {"dps368_idle", "nA", 500},
+	[ENERGY_DPS368_MEASURE] = {"dps368_measure", "nA", 400000},
+	// Cell capacity for the projections.
+	[ENERGY_BATTERY] = {"battery", "uAh", 100000},
+};
+
+enum energy_part
+{
+    ENERGY_PART_IDLE,
+    ENERGY_PART_CPU,
+    ENERGY_PART_WAKEUP,
+    ENERGY_PART_SPI,
+    ENERGY_PART_FLASH,
+    ENERGY_PART_RADIO,
+    ENERGY_PART_LIS3DH,
+    ENERGY_PART_DPS368,
+    ENERGY_PART_COUNT
+};
+
+static const char *energy_part_names[ENERGY_PART_COUNT] = {
+	"idle", "cpu", "wakeups", "spi", "flash", "radio", "lis3dh", "dps368",
+};
+
+struct energy_counts {
+	int64_t ms;
+	uint64_t active_us;
+	uint32_t wakeups;
+	uint32_t spi_transactions[SPI_MAX_DEVICES];
+	uint32_t spi_bytes[SPI_MAX_DEVICES];
+	uint32_t flash_bytes;
+	uint32_t flash_erases;
+	uint64_t radio_us;
+	uint64_t dps368_us;
+	uint32_t event_waits;
+	uint64_t event_wait_ms;
+};
+
+static struct energy_counts energy_start;
+
+static const char *energy_device_names[SPI_MAX_DEVICES] = {
+	[DT_REG_ADDR(DT_NODELABEL(lis3dh))] = "lis3dh",
+	[DT_REG_ADDR(DT_NODELABEL(dps368))] = "dps368",
+};
+
+static uint32_t energy_param(enum energy_param_id id)
+{
+	return energy_params[id].value;
+}
+
+static void energy_count(struct energy_counts *c)
+{
+	c->ms = k_uptime_get();
+
+#ifdef CONFIG_APP_ENERGY_CPU
+	k_thread_runtime_stats_t stats;
+	k_thread_runtime_stats_all_get(&stats);
+	c->active_us = k_cyc_to_us_floor64(stats.total_cycles);
+#else
+	c->active_us = 0;
+#endif
+
+	c->wakeups = sched_wakeups + recorder_wakeups + main_event_waits;
+#ifdef CONFIG_BT
+	c->wakeups += stream_wakeups;
+	c->radio_us = stream_radio_us();
+#else
+	c->radio_us = 0;
+#endif
+#ifdef CONFIG_USE_SEGGER_RTT
+	c->wakeups += rtt_wakeups;
+#endif
+
+	for (int i = 0; i < SPI_MAX_DEVICES; i++) {
+		c->spi_transactions[i] = spi_device_stats[i].transactions;
+		c->spi_bytes[i] = spi_device_stats[i].bytes;
+	}
+	c->flash_bytes = recorder_bytes;
+	c->flash_erases = recorder_erases;
+	c->dps368_us = dps368_measure_us;
+	c->event_waits = main_event_waits;
+	c->event_wait_ms = main_event_wait_ms;
+}
+
+// Counts since the last mark.
+static void energy_window(struct energy_counts *d)
+{
+	struct energy_counts *s = &energy_start;
+
+	energy_count(d);
+	d->ms -= s->ms;
+	d->active_us -= s->active_us;
+	d->wakeups -= s->wakeups;
+	for (int i = 0; i < SPI_MAX_DEVICES; i++) {
+		d->spi_transactions[i] -= s->spi_transactions[i];
+		d->spi_bytes[i] -= s->spi_bytes[i];
+	}
+	d->flash_bytes -= s->flash_bytes;
+	d->flash_erases -= s->flash_erases;
+	d->radio_us -= s->radio_us;
+	d->dps368_us -= s->dps368_us;
+	d->event_waits -= s->event_waits;
+	d->event_wait_ms -= s->event_wait_ms;
+}
+
+// Charge per part in pC over the window d.
+static void energy_estimate(const struct energy_counts *d, double pc[ENERGY_PART_COUNT])
+{
+	uint32_t transactions = 0;
+	uint32_t bytes = 0;
+	bool low_power;
+	uint32_t lis3dh_rate = lis3dh_sample_rate(&low_power);
+	uint32_t lis3dh_sample =
+		energy_param(low_power ? ENERGY_LIS3DH_LP_SAMPLE : ENERGY_LIS3DH_SAMPLE);
+
+	for (int i = 0; i < SPI_MAX_DEVICES; i++) {
+		transactions += d->spi_transactions[i];
+		bytes += d->spi_bytes[i];
+	}
+
+	pc[ENERGY_PART_IDLE] = (double)d->ms * energy_param(ENERGY_NRF_IDLE);
+	pc[ENERGY_PART_CPU] = d->active_us * (double)energy_param(ENERGY_NRF_RUN) / 1000;
+	pc[ENERGY_PART_WAKEUP] = (double)d->wakeups * energy_param(ENERGY_NRF_WAKEUP);
+	pc[ENERGY_PART_SPI] = (double)transactions * energy_param(ENERGY_SPI_XFER) +
+			      (double)bytes * energy_param(ENERGY_SPI_BYTE);
+	pc[ENERGY_PART_FLASH] = (double)d->flash_bytes * energy_param(ENERGY_FLASH_BYTE) +
+				(double)d->flash_erases * energy_param(ENERGY_FLASH_ERASE);
+	pc[ENERGY_PART_RADIO] = d->radio_us * (double)energy_param(ENERGY_RADIO) / 1000;
+	pc[ENERGY_PART_LIS3DH] = (double)d->ms * energy_param(ENERGY_LIS3DH_IDLE) +
+				 (double)d->ms * lis3dh_rate / 1000 * lis3dh_sample;
+	pc[ENERGY_PART_DPS368] = (double)d->ms * energy_param(ENERGY_DPS368_IDLE) +
+				 d->dps368_us * (double)energy_param(ENERGY_DPS368_MEASURE) / 1000;
+}
+
+// After sys_poweroff() the RTC stops, so time off can't be counted; this is what it draws:
+// System OFF, the LIS3DH waking on Z at LIS3DH_WAKE_RATE_HZ in low power, and the DPS368 in
+// standby.
+static double energy_off_ua(void)
+{
+	// pC per sample times samples per second is pC per second, a thousandth of that per ms.
+	double lis3dh_na = energy_param(ENERGY_LIS3DH_IDLE) +
+			   energy_param(ENERGY_LIS3DH_LP_SAMPLE) * LIS3DH_WAKE_RATE_HZ / 1000.0;
+
+	return (energy_param(ENERGY_NRF_OFF) + lis3dh_na + energy_param(ENERGY_DPS368_IDLE)) /
+	       1000.0;
+}
+
+void energy_mark(void)
+{
+	energy_count(&energy_start);
+}
+
+void energy_log(void)
+{
+	struct energy_counts d;
+	double pc[ENERGY_PART_COUNT];
+	double total = 0;
+
+	energy_window(&d);
+	energy_estimate(&d, pc);
+	for (int i = 0; i < ENERGY_PART_COUNT; i++) {
+		total += pc[i];
+	}
+	LOG_INF("%u ms since mark: ~%.1f uAh, %.2f uA average; %.2f uA after poweroff",
+		(uint32_t)d.ms, total / ENERGY_PC_PER_UAH, d.ms ? total / d.ms / 1000 : 0.0,
+		energy_off_ua());
+}
+
+static int cmd_energy_show(const struct shell *shell, size_t argc, char *argv[])
+{
+	struct energy_counts d;
+	double pc[ENERGY_PART_COUNT];
+	double total = 0;
+
+	energy_window(&d);
+	if (d.ms <= 0) {
+		shell_fprintf(shell, SHELL_ERROR, "Nothing counted yet\n");
+		return -1;
+	}
+	energy_estimate(&d, pc);
+
+	double seconds = d.ms / 1000.0;
+	shell_fprintf(shell, SHELL_NORMAL, "Energy over the last %.1f s:\n", seconds);
+	shell_fprintf(shell, SHELL_NORMAL, " wakeups: %u (%.1f/s)", d.wakeups, d.wakeups / seconds);
+	if (IS_ENABLED(CONFIG_APP_ENERGY_CPU)) {
+		shell_fprintf(shell, SHELL_NORMAL, " cpu: %llu us (%.2f%%)\n", d.active_us,
+			      d.active_us / (seconds * 1e4));
+	} else {
+		shell_fprintf(shell, SHELL_NORMAL, " cpu: not counted\n");
+	}
+	for (int i = 0; i < SPI_MAX_DEVICES; i++) {
+		const char *name = energy_device_names[i] ? energy_device_names[i] : "other";
+
+		shell_fprintf(shell, SHELL_NORMAL,
+			      " spi %s: %u transactions, %u bytes (%.0f B/s)\n", name,
+			      d.spi_transactions[i], d.spi_bytes[i], d.spi_bytes[i] / seconds);
+	}
+	shell_fprintf(shell, SHELL_NORMAL,
+		      " flash: %u bytes, %u erases; radio on: %llu us; dps368 measuring: %llu us\n",
+		      d.flash_bytes, d.flash_erases, d.radio_us, d.dps368_us);
+	shell_fprintf(shell, SHELL_NORMAL, " main: %u event waits, %llu ms\n", d.event_waits,
+		      d.event_wait_ms);
+
+	shell_fprintf(shell, SHELL_NORMAL, " uAh/min:");
+	for (int i = 0; i < ENERGY_PART_COUNT; i++) {
+		shell_fprintf(shell, SHELL_NORMAL, " %s=%.4f", energy_part_names[i],
+			      pc[i] / ENERGY_PC_PER_UAH * 60000 / d.ms);
+		total += pc[i];
+	}
+	shell_fprintf(shell, SHELL_NORMAL, "\n");
+
+	double ua = total / d.ms / 1000;
+	double battery = energy_param(ENERGY_BATTERY);
+	shell_fprintf(shell, SHELL_NORMAL, " total: %.4f uAh/min, %.2f uA, %.1f h of recording\n",
+		      ua / 60, ua, battery / ua);
+	shell_fprintf(shell, SHELL_NORMAL, " poweroff: %.2f uA, %.0f days\n", energy_off_ua(),
+		      battery / energy_off_ua() / 24);
+	return 0;
+}
+
+static int cmd_energy_reset(const struct shell *shell, size_t argc, char *argv[])
+{
+	energy_mark();
+	return 0;
+}
+
+static int cmd_energy_params(const struct shell *shell, size_t argc, char *argv[])
+{
+	shell_fprintf(shell, SHELL_NORMAL, "Energy model:\n");
+	for (int i = 0; i < ENERGY_PARAM_COUNT; i++) {
+		shell_fprintf(shell, SHELL_NORMAL, " %s: %u %s\n", energy_params[i].name,
+			      energy_params[i].value, energy_params[i].unit);
+	}
+	return 0;
+}
+
+static int cmd_energy_set(const struct shell *shell, size_t argc, char *argv[])
+{
+	for (int i = 0; i < ENERGY_PARAM_COUNT; i++) {
+		if (strcmp(energy_params[i].name, argv[1]) == 0) {
+			energy_params[i].value = strtoul(argv[2], NULL, 0);
+			return 0;
+		}
+	}
+	shell_fprintf(shell, SHELL_ERROR, "Unknown parameter: %s, see energy params\n", argv[1]);
+	return -1;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(
+	energy_cmds,
+	SHELL_CMD_ARG(params, NULL, "print the model's currents and charges", cmd_energy_params,
+		      1, 0),
+	SHELL_CMD_ARG(reset, NULL, "count from now", cmd_energy_reset, 1, 0),
+	SHELL_CMD_ARG(set, NULL, "set a parameter: NAME VALUE", cmd_energy_set, 3, 0),
+	SHELL_CMD_ARG(show, NULL, "print counters and the estimate since the last mark",
+		      cmd_energy_show, 1, 0),
+	SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(energy, &energy_cmds, "Energy accounting", NULL);
@@ -0,0 +1,425 @@
+#define DT_DRV_COMPAT kartcam_lis3dh_spi
+
+#include "common.h"
+
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <zephyr/drivers/spi_emul.h>
+
+LOG_MODULE_REGISTER(lis3dh_emul);
+
+// LIS3DH on the native_sim SPI emulator bus. It models what lis3dh.c relies on: the register
+// map, the sample clock, the 32 level FIFO in bypass, FIFO and stream mode with its watermark
+// and overrun flags, the OUT_X_L..OUT_Z_H burst that pops one record, and INT1. Samples come
+// from the shared waveform (see emul.c) at the time the sensor takes them, and INT1 is driven
+// through the GPIO emulator when they are due, so the firmware sees the FIFO fill in real time.
+
+#define LIS3DH_REG_WHO_AM_I          0x0F
+#define LIS3DH_REG_CTRL_REG1         0x20
+#define LIS3DH_REG_CTRL_REG1_LPEN    BIT(3)
+#define LIS3DH_REG_CTRL_REG3         0x22
+#define LIS3DH_REG_CTRL_REG3_I1_IA1  BIT(6)
+#define LIS3DH_REG_CTRL_REG3_I1_WTM  BIT(2)
+#define LIS3DH_REG_CTRL_REG3_I1_OVRN BIT(1)
+#define LIS3DH_REG_CTRL_REG4         0x23
+#define LIS3DH_REG_CTRL_REG4_HR      BIT(3)
+#define LIS3DH_REG_CTRL_REG5         0x24
+#define LIS3DH_REG_CTRL_REG5_FIFO_EN BIT(6)
+#define LIS3DH_REG_STATUS_REG        0x27
+#define LIS3DH_REG_OUT_X_L           0x28
+#define LIS3DH_REG_OUT_Z_H           0x2D
+#define LIS3DH_REG_FIFO_CTRL         0x2E
+#define LIS3DH_REG_FIFO_SRC          0x2F
+#define LIS3DH_REG_INT1_CFG          0x30
+#define LIS3DH_REG_INT1_CFG_ZHIE     BIT(5)
+#define LIS3DH_REG_INT1_SRC          0x31
+#define LIS3DH_REG_INT1_THS          0x32
+#define LIS3DH_REG_COUNT             0x40
+
+#define LIS3DH_FIFO_SIZE 32
+
+enum lis3dh_emul_fifo_mode {
+	LIS3DH_EMUL_BYPASS,
+	LIS3DH_EMUL_FIFO,
+	LIS3DH_EMUL_STREAM,
+	LIS3DH_EMUL_STREAM_TO_FIFO, // modelled as stream, nothing here triggers the switch
+};
+
+struct lis3dh_emul_config {
+	struct gpio_dt_spec int1;
+};
+
+struct lis3dh_emul_data {
+	struct k_spinlock lock;
+	struct k_timer timer;
+	const struct lis3dh_emul_config *config;
+	uint8_t regs[LIS3DH_REG_COUNT];
+
+	// Sample clock: sample n is taken at start_us + (n + 1) / odr.
+	uint32_t odr;
+	uint64_t start_us;
+	uint64_t next;
+
+	int16_t fifo[LIS3DH_FIFO_SIZE][3];
+	uint8_t head;
+	uint8_t level;
+	int16_t out[3];
+	bool skip;
+	bool ia1;
+	bool int1;
+
+	// The burst in progress.
+	uint8_t addr;
+	bool read;
+	bool inc;
+
+	uint32_t samples;
+	uint32_t overwritten;
+	uint32_t dropped;
+	uint32_t records;
+};
+
+static struct lis3dh_emul_data *lis3dh_emul;
+
+static const float lis3dh_emul_mg_per_lsb[] = {0.0625f, 0.125f, 0.25f, 0.75f};
+static const uint16_t lis3dh_emul_ths_mg[] = {16, 32, 62, 186};
+static const uint16_t lis3dh_emul_odr_table[] = {0, 1, 10, 25, 50, 100, 200, 400, 1600, 1344};
+
+static enum lis3dh_emul_fifo_mode lis3dh_emul_mode(const struct lis3dh_emul_data *data)
+{
+	if (!(data->regs[LIS3DH_REG_CTRL_REG5] & LIS3DH_REG_CTRL_REG5_FIFO_EN)) {
+		return LIS3DH_EMUL_BYPASS;
+	}
+	return data->regs[LIS3DH_REG_FIFO_CTRL] >> 6;
+}
+
+static uint32_t lis3dh_emul_odr(const struct lis3dh_emul_data *data)
+{
+	uint8_t odr = data->regs[LIS3DH_REG_CTRL_REG1] >> 4;
+	bool low_power = data->regs[LIS3DH_REG_CTRL_REG1] & LIS3DH_REG_CTRL_REG1_LPEN;
+
+	if (odr >= ARRAY_SIZE(lis3dh_emul_odr_table)) {
+		return 0;
+	}
+	// The top rate is 1.344 kHz, or 5.376 kHz in low power mode.
+	return odr == 9 && low_power ? 5376 : lis3dh_emul_odr_table[odr];
+}
+
+// Output words are left-justified: 8 bits in low power, 10 in normal and 12 in high resolution.
+static int16_t lis3dh_emul_code(const struct lis3dh_emul_data *data, float mg)
+{
+	uint8_t fs = (data->regs[LIS3DH_REG_CTRL_REG4] >> 4) & 0x3;
+	uint8_t shift = 6;
+	float code = floorf(mg / lis3dh_emul_mg_per_lsb[fs]);
+
+	if (data->regs[LIS3DH_REG_CTRL_REG1] & LIS3DH_REG_CTRL_REG1_LPEN) {
+		shift = 8;
+	} else if (data->regs[LIS3DH_REG_CTRL_REG4] & LIS3DH_REG_CTRL_REG4_HR) {
+		shift = 4;
+	}
+
+	code = CLAMP(code, INT16_MIN, INT16_MAX);
+	return (int16_t)((int32_t)code & ~((1 << shift) - 1));
+}
+
+static void lis3dh_emul_take(struct lis3dh_emul_data *data, uint64_t t_us)
+{
+	struct emul_frame f;
+	uint8_t fs = (data->regs[LIS3DH_REG_CTRL_REG4] >> 4) & 0x3;
+	enum lis3dh_emul_fifo_mode mode = lis3dh_emul_mode(data);
+
+	emul_frame(t_us, &f);
+	for (int axis = 0; axis < 3; axis++) {
+		data->out[axis] = lis3dh_emul_code(data, f.accel[axis]);
+	}
+	// Errata: the first sample after the FIFO is enabled is invalid.
+	if (data->skip && mode != LIS3DH_EMUL_BYPASS) {
+		memset(data->out, 0, sizeof(data->out));
+		data->skip = false;
+	}
+	data->ia1 = (data->regs[LIS3DH_REG_INT1_CFG] & LIS3DH_REG_INT1_CFG_ZHIE) &&
+		    f.accel[2] > data->regs[LIS3DH_REG_INT1_THS] * lis3dh_emul_ths_mg[fs];
+	data->samples++;
+
+	if (mode == LIS3DH_EMUL_BYPASS) {
+		return;
+	}
+	if (data->level == LIS3DH_FIFO_SIZE) {
+		if (mode == LIS3DH_EMUL_FIFO) {
+			data->dropped++;
+			return;
+		}
+		data->head = (data->head + 1) % LIS3DH_FIFO_SIZE;
+		data->level--;
+		data->overwritten++;
+	}
+	memcpy(data->fifo[(data->head + data->level) % LIS3DH_FIFO_SIZE], data->out,
+	       sizeof(data->out));
+	data->level++;
+}
+
+// Takes every sample due by now. After a long quiet spell only the last FIFO's worth can still
+// be read, so older ones are only counted.
+static void lis3dh_emul_sample(struct lis3dh_emul_data *data, uint64_t now)
+{
+	if (data->odr == 0 || now < data->start_us) {
+		return;
+	}
+
+	uint64_t due = (now - data->start_us) * data->odr / 1000000;
+	enum lis3dh_emul_fifo_mode mode = lis3dh_emul_mode(data);
+
+	if (mode != LIS3DH_EMUL_FIFO && due > data->next + LIS3DH_FIFO_SIZE) {
+		uint64_t skipped = due - data->next - LIS3DH_FIFO_SIZE;
+
+		data->samples += skipped;
+		data->overwritten += mode == LIS3DH_EMUL_BYPASS ? 0 : skipped;
+		data->next += skipped;
+	}
+	while (data->next < due) {
+		if (mode == LIS3DH_EMUL_FIFO && data->level == LIS3DH_FIFO_SIZE) {
+			data->samples += due - data->next;
+			data->dropped += due - data->next;
+			data->next = due;
+			break;
+		}
+		data->next++;
+		lis3dh_emul_take(data, data->start_us + data->next * 1000000 / data->odr);
+	}
+}
+
+static bool lis3dh_emul_int1(const struct lis3dh_emul_data *data)
+{
+	uint8_t ctrl_reg3 = data->regs[LIS3DH_REG_CTRL_REG3];
+	uint8_t fth = data->regs[LIS3DH_REG_FIFO_CTRL] & 0x1F;
+	bool fifo = lis3dh_emul_mode(data) != LIS3DH_EMUL_BYPASS;
+
+	return (ctrl_reg3 & LIS3DH_REG_CTRL_REG3_I1_WTM && fifo && data->level > fth) ||
+	       (ctrl_reg3 & LIS3DH_REG_CTRL_REG3_I1_OVRN && fifo &&
+		data->level == LIS3DH_FIFO_SIZE) ||
+	       (ctrl_reg3 & LIS3DH_REG_CTRL_REG3_I1_IA1 && data->ia1);
+}
+
+// Sets the timer for the sample that may next change INT1.
+static void lis3dh_emul_arm(struct lis3dh_emul_data *data, uint64_t now)
+{
+	uint8_t ctrl_reg3 = data->regs[LIS3DH_REG_CTRL_REG3];
+	uint8_t fth = data->regs[LIS3DH_REG_FIFO_CTRL] & 0x1F;
+	bool fifo = lis3dh_emul_mode(data) != LIS3DH_EMUL_BYPASS;
+	uint32_t samples = 0;
+
+	if (ctrl_reg3 & LIS3DH_REG_CTRL_REG3_I1_IA1) {
+		samples = 1;
+	} else if (ctrl_reg3 & LIS3DH_REG_CTRL_REG3_I1_WTM && fifo && data->level <= fth) {
+		samples = fth + 1 - data->level;
+	} else if (ctrl_reg3 & LIS3DH_REG_CTRL_REG3_I1_OVRN && fifo &&
+		   data->level < LIS3DH_FIFO_SIZE) {
+		samples = LIS3DH_FIFO_SIZE - data->level;
+	}
+
+	if (data->odr == 0 || samples == 0) {
+		k_timer_stop(&data->timer);
+		return;
+	}
+
+	uint64_t at = data->start_us + (data->next + samples) * 1000000 / data->odr;
+	k_timer_start(&data->timer, K_USEC(at > now ? at - now : 0), K_NO_WAIT);
+}
+
+// Brings the model up to now and returns the INT1 level, which the caller drives once the lock
+// is dropped, as the GPIO emulator runs the firmware's callbacks straight away.
+static bool lis3dh_emul_update(struct lis3dh_emul_data *data, uint64_t now, bool *changed)
+{
+	lis3dh_emul_sample(data, now);
+	lis3dh_emul_arm(data, now);
+
+	bool int1 = lis3dh_emul_int1(data);
+	*changed = int1 != data->int1;
+	data->int1 = int1;
+	return int1;
+}
+
+static void lis3dh_emul_drive(struct lis3dh_emul_data *data, bool int1)
+{
+	const struct gpio_dt_spec *spec = &data->config->int1;
+
+	gpio_emul_input_set(spec->port, spec->pin, int1);
+}
+
+static void lis3dh_emul_expiry(struct k_timer *timer)
+{
+	struct lis3dh_emul_data *data = CONTAINER_OF(timer, struct lis3dh_emul_data, timer);
+	bool changed;
+
+	k_spinlock_key_t key = k_spin_lock(&data->lock);
+	bool int1 = lis3dh_emul_update(data, emul_time_us(), &changed);
+	k_spin_unlock(&data->lock, key);
+
+	if (changed) {
+		lis3dh_emul_drive(data, int1);
+	}
+}
+
+static uint8_t lis3dh_emul_read(struct lis3dh_emul_data *data, uint8_t addr)
+{
+	uint8_t fth = data->regs[LIS3DH_REG_FIFO_CTRL] & 0x1F;
+	bool fifo = lis3dh_emul_mode(data) != LIS3DH_EMUL_BYPASS;
+
+	switch (addr) {
+	case LIS3DH_REG_WHO_AM_I:
+		return 0x33;
+	case LIS3DH_REG_STATUS_REG:
+		return data->samples ? 0x0F : 0;
+	case LIS3DH_REG_OUT_X_L ... LIS3DH_REG_OUT_Z_H: {
+		// With the FIFO on, the output registers show its oldest record, and reading the
+		// last byte of it pops it.
+		const int16_t *record = fifo && data->level ? data->fifo[data->head] : data->out;
+		uint8_t i = addr - LIS3DH_REG_OUT_X_L;
+		uint8_t value = (uint16_t)record[i / 2] >> (8 * (i % 2));
+
+		if (addr == LIS3DH_REG_OUT_Z_H && fifo && data->level) {
+			data->head = (data->head + 1) % LIS3DH_FIFO_SIZE;
+			data->level--;
+			data->records++;
+		}
+		return value;
+	}
+	case LIS3DH_REG_FIFO_SRC:
+		// FSS tops out at 31; OVRN means all 32 slots are full.
+		return (data->level > fth ? BIT(7) : 0) |
+		       (data->level == LIS3DH_FIFO_SIZE ? BIT(6) : 0) | (data->level ? 0 : BIT(5)) |
+		       MIN(data->level, 31);
+	case LIS3DH_REG_INT1_SRC:
+		return data->ia1 ? BIT(6) | BIT(5) : 0;
+	default:
+		return data->regs[addr];
+	}
+}
+
+static void lis3dh_emul_write(struct lis3dh_emul_data *data, uint8_t addr, uint8_t value,
+			      uint64_t now)
+{
+	enum lis3dh_emul_fifo_mode mode = lis3dh_emul_mode(data);
+
+	switch (addr) {
+	case LIS3DH_REG_WHO_AM_I:
+	case LIS3DH_REG_STATUS_REG:
+	case LIS3DH_REG_OUT_X_L ... LIS3DH_REG_OUT_Z_H:
+	case LIS3DH_REG_FIFO_SRC:
+	case LIS3DH_REG_INT1_SRC:
+		return;
+	}
+	data->regs[addr] = value;
+
+	if (addr == LIS3DH_REG_CTRL_REG1) {
+		data->odr = lis3dh_emul_odr(data);
+		data->start_us = now;
+		data->next = 0;
+	}
+
+	enum lis3dh_emul_fifo_mode new_mode = lis3dh_emul_mode(data);
+	if (new_mode == LIS3DH_EMUL_BYPASS) {
+		data->head = 0;
+		data->level = 0;
+	} else if (mode == LIS3DH_EMUL_BYPASS) {
+		data->skip = true;
+	}
+}
+
+static uint8_t lis3dh_emul_xfer(void *ctx, size_t pos, uint8_t mosi)
+{
+	struct lis3dh_emul_data *data = ctx;
+	uint8_t miso = 0;
+
+	if (pos == 0) {
+		data->addr = mosi & 0x3F;
+		data->read = mosi & 0x80;
+		data->inc = mosi & 0x40;
+		return 0xFF;
+	}
+
+	if (data->read) {
+		miso = lis3dh_emul_read(data, data->addr);
+	} else {
+		lis3dh_emul_write(data, data->addr, mosi, emul_time_us());
+	}
+
+	// With the FIFO on, bursts wrap from OUT_Z_H back to OUT_X_L.
+	if (data->inc) {
+		bool fifo = lis3dh_emul_mode(data) != LIS3DH_EMUL_BYPASS;
+
+		if (fifo && data->addr == LIS3DH_REG_OUT_Z_H) {
+			data->addr = LIS3DH_REG_OUT_X_L;
+		} else {
+			data->addr = (data->addr + 1) % LIS3DH_REG_COUNT;
+		}
+	}
+	return miso;
+}
+
+static int lis3dh_emul_io(const struct emul *target, const struct spi_config *config,
+			  const struct spi_buf_set *tx_bufs, const struct spi_buf_set *rx_bufs)
+{
+	struct lis3dh_emul_data *data = target->data;
+	uint64_t now = emul_time_us();
+	bool changed;
+
+	k_spinlock_key_t key = k_spin_lock(&data->lock);
+	lis3dh_emul_sample(data, now);
+	emul_spi_io(tx_bufs, rx_bufs, lis3dh_emul_xfer, data);
+	bool int1 = lis3dh_emul_update(data, now, &changed);
+	k_spin_unlock(&data->lock, key);
+
+	if (changed) {
+		lis3dh_emul_drive(data, int1);
+	}
+	return 0;
+}
+
+static const struct spi_emul_api lis3dh_emul_api = {
+	.io = lis3dh_emul_io,
+};
+
+static int lis3dh_emul_init(const struct emul *target, const struct device *parent)
+{
+	struct lis3dh_emul_data *data = target->data;
+
+	data->config = target->cfg;
+	// Power-on defaults: powered down, all axes enabled.
+	data->regs[LIS3DH_REG_CTRL_REG1] = 0x07;
+	k_timer_init(&data->timer, lis3dh_emul_expiry, NULL);
+	lis3dh_emul = data;
+	return 0;
+}
+
+void lis3dh_emul_status(const struct shell *shell)
+{
+	struct lis3dh_emul_data *data = lis3dh_emul;
+
+	if (data == NULL) {
+		return;
+	}
+
+	k_spinlock_key_t key = k_spin_lock(&data->lock);
+	shell_fprintf(shell, SHELL_NORMAL,
+		      " lis3dh: odr=%u Hz fifo=%u samples=%u read=%u overwritten=%u dropped=%u "
+		      "int1=%d\n",
+		      data->odr, data->level, data->samples, data->records, data->overwritten,
+		      data->dropped, data->int1);
+	k_spin_unlock(&data->lock, key);
+}
+
+// The firmware drives the sensor over raw SPI, so there is no driver device for the node; the
+// emulator framework wants one, and an empty device stands in.
+#define LIS3DH_EMUL(n)                                                                             \
+	static struct lis3dh_emul_data lis3dh_emul_data_##n;                                       \
+	static const struct lis3dh_emul_config lis3dh_emul_config_##n = {                          \
+		.int1 = GPIO_DT_SPEC_INST_GET(n, int_gpios),                                       \
+	};                                                                                         \
+	EMUL_DT_INST_DEFINE(n, lis3dh_emul_init, &lis3dh_emul_data_##n, &lis3dh_emul_config_##n,   \
+			    &lis3dh_emul_api, NULL);                                               \
+	DEVICE_DT_INST_DEFINE(n, NULL, NULL, NULL, NULL, POST_KERNEL,                              \
+			      CONFIG_KERNEL_INIT_PRIORITY_DEVICE, NULL);
+
+DT_INST_FOREACH_STATUS_OKAY(LIS3DH_EMUL)
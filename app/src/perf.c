@@ -0,0 +1,144 @@
+#include "common.h"
+
+#ifdef CONFIG_CPU_CORTEX_M_HAS_DWT
+#include <cmsis_core.h>
+#endif
+
+LOG_MODULE_REGISTER(perf);
+
+//
+// Per-stage cycle counts for finding where a recording's CPU time goes. Each stage is timed
+// around its call sites with PERF_START()/PERF_END() and keeps the min, max and total of its
+// timings, how many items (samples, bytes, entries) they covered, and a histogram of timings in
+// power of two bins. All of it compiles out without CONFIG_APP_PERF.
+//
+// On the Cortex-M the cycles are the DWT's CYCCNT, which counts CPU clocks. Elsewhere they come
+// from k_cycle_get_32(). On native_sim that is simulated time, which stands still while code runs
+// and the emulated SPI completes at once, so timings read zero there; calls and items still count.
+//
+#define PERF_BINS 24
+
+#ifdef CONFIG_CPU_CORTEX_M_HAS_DWT
+#define PERF_CYCLES_PER_SEC DT_PROP_OR(DT_PATH(cpus, cpu_0), clock_frequency, 64000000)
+#else
+#define PERF_CYCLES_PER_SEC sys_clock_hw_cycles_per_sec()
+#endif
+
+struct perf_stats {
+	uint32_t calls;
+	uint32_t items;
+	uint32_t min;
+	uint32_t max;
+	uint64_t total;
+	uint32_t bins[PERF_BINS];
+};
+
+const char *perf_stage_names[PERF_STAGE_COUNT] = {
+	"spi_reg", "spi_burst", "dps368_comp", "encode", "reserve", "commit", "service",
+};
+
+static struct k_spinlock perf_lock;
+static struct perf_stats perf_stats[PERF_STAGE_COUNT];
+
+uint32_t perf_cycles(void)
+{
+#ifdef CONFIG_CPU_CORTEX_M_HAS_DWT
+	return DWT->CYCCNT;
+#else
+	return k_cycle_get_32();
+#endif
+}
+
+void perf_add(enum perf_stage stage, uint32_t cycles, uint32_t items)
+{
+	// Bin b counts timings in [2^b, 2^(b+1)); the last one takes everything longer.
+	uint8_t bin = MIN(31 - __builtin_clz(cycles | 1), PERF_BINS - 1);
+
+	k_spinlock_key_t key = k_spin_lock(&perf_lock);
+	struct perf_stats *s = &perf_stats[stage];
+
+	s->min = s->calls ? MIN(s->min, cycles) : cycles;
+	s->max = MAX(s->max, cycles);
+	s->calls++;
+	s->items += items;
+	s->total += cycles;
+	s->bins[bin]++;
+
+	k_spin_unlock(&perf_lock, key);
+}
+
+static void perf_reset(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&perf_lock);
+	memset(perf_stats, 0, sizeof(perf_stats));
+	k_spin_unlock(&perf_lock, key);
+}
+
+static uint32_t perf_ns(uint64_t cycles)
+{
+	return cycles * 1000000000 / PERF_CYCLES_PER_SEC;
+}
+
+static int perf_init(void)
+{
+#ifdef CONFIG_CPU_CORTEX_M_HAS_DWT
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+	return 0;
+}
+
+SYS_INIT(perf_init, APPLICATION, 0);
+
+static int cmd_perf_show(const struct shell *shell, size_t argc, char *argv[])
+{
+	struct perf_stats stats[PERF_STAGE_COUNT];
+
+	k_spinlock_key_t key = k_spin_lock(&perf_lock);
+	memcpy(stats, perf_stats, sizeof(stats));
+	k_spin_unlock(&perf_lock, key);
+
+	shell_fprintf(shell, SHELL_NORMAL, "Stage timings (%u cycles/s):\n", PERF_CYCLES_PER_SEC);
+	for (int i = 0; i < PERF_STAGE_COUNT; i++) {
+		struct perf_stats *s = &stats[i];
+
+		if (s->calls == 0) {
+			shell_fprintf(shell, SHELL_NORMAL, " %s: -\n", perf_stage_names[i]);
+			continue;
+		}
+
+		uint32_t avg = s->total / s->calls;
+		shell_fprintf(shell, SHELL_NORMAL,
+			      " %s: calls=%u min/avg/max=%u/%u/%u cycles (%u/%u/%u ns)",
+			      perf_stage_names[i], s->calls, s->min, avg, s->max, perf_ns(s->min),
+			      perf_ns(avg), perf_ns(s->max));
+		if (s->items > 0) {
+			shell_fprintf(shell, SHELL_NORMAL, " items=%u %u ns/item", s->items,
+				      perf_ns(s->total / s->items));
+		}
+		shell_fprintf(shell, SHELL_NORMAL, "\n  log2:");
+		for (int b = 0; b < PERF_BINS; b++) {
+			if (s->bins[b]) {
+				shell_fprintf(shell, SHELL_NORMAL, " %d:%u", b, s->bins[b]);
+			}
+		}
+		shell_fprintf(shell, SHELL_NORMAL, "\n");
+	}
+	return 0;
+}
+
+static int cmd_perf_reset(const struct shell *shell, size_t argc, char *argv[])
+{
+	perf_reset();
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(perf_cmds,
+			       SHELL_CMD_ARG(show, NULL, "print stage timings", cmd_perf_show, 1,
+					     0),
+			       SHELL_CMD_ARG(reset, NULL, "clear stage timings", cmd_perf_reset, 1,
+					     0),
+			       SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(perf, &perf_cmds, "Pipeline stage timings", NULL);
@@ -0,0 +1,106 @@
+#include "common.h"
+#include "rans_tables.h"
+
+//
+// Static-model byte-wise rANS, after https://github.com/rygorous/ryg_rans (rans_byte.h).
+//
+// The codec re-codes a finished delta8 token stream: each token is one symbol of the channel's
+// model, and the two payload bytes after a 0xff escape are coded with a flat distribution. The
+// decoder stops when the input is consumed and the state is back at RANS_BYTE_L, so no sample
+// count is needed in the packet. See scripts/plot/packet.py for the host decoder.
+//
+// Tables are generated by scripts/plot/gen_rans_tables.py.
+//
+
+LOG_MODULE_REGISTER(rans);
+
+#define RANS_SCALE_BITS   12
+#define RANS_BYTE_L       (1u << 23)
+#define RANS_ESCAPE       0xff
+#define RANS_UNIFORM_FREQ (1u << (RANS_SCALE_BITS - 8))
+#define RANS_MAX_LEN      1024
+
+// Shared by all producers; rans_mutex only serializes sections that are being rANS coded.
+static uint8_t rans_scratch[RANS_MAX_LEN];
+static uint32_t rans_token_map[RANS_MAX_LEN / 32];
+
+K_MUTEX_DEFINE(rans_mutex);
+
+static bool rans_put(uint32_t *x, uint8_t **ptr, uint8_t *limit, uint32_t start, uint32_t freq)
+{
+	uint32_t x_max = ((RANS_BYTE_L >> RANS_SCALE_BITS) << 8) * freq;
+	uint32_t v = *x;
+
+	while (v >= x_max) {
+		if (*ptr == limit) {
+			return false;
+		}
+		*--(*ptr) = v & 0xff;
+		v >>= 8;
+	}
+
+	*x = ((v / freq) << RANS_SCALE_BITS) + (v % freq) + start;
+	return true;
+}
+
+static int rans_encode_locked(enum channel ch, enum quantize quant, uint8_t *data, uint16_t len)
+{
+	const uint16_t *freq = rans_model_freq[rans_model_index[ch][quant]];
+	const uint16_t *start = rans_model_start[rans_model_index[ch][quant]];
+
+	// Tokens have to be coded in reverse, so mark where each one starts first; walking the
+	// stream backwards can't tell escape payload bytes from 0xff tokens.
+	memset(rans_token_map, 0, sizeof(rans_token_map));
+	for (uint16_t i = 0; i < len; i += (data[i] == RANS_ESCAPE) ? 3 : 1) {
+		rans_token_map[i / 32] |= BIT(i % 32);
+	}
+
+	// Only keep the result if it's strictly smaller, leaving room for the 4 byte state flush.
+	uint8_t *end = rans_scratch + len - 1;
+	uint8_t *limit = rans_scratch + 4;
+	uint8_t *ptr = end;
+	uint32_t x = RANS_BYTE_L;
+
+	if (end <= limit) {
+		return -1;
+	}
+
+	for (int i = len - 1; i >= 0; i--) {
+		uint8_t s = data[i];
+		bool ok;
+		if (rans_token_map[i / 32] & BIT(i % 32)) {
+			ok = rans_put(&x, &ptr, limit, start[s], freq[s]);
+		} else {
+			ok = rans_put(&x, &ptr, limit, s * RANS_UNIFORM_FREQ, RANS_UNIFORM_FREQ);
+		}
+		if (!ok) {
+			return -1;
+		}
+	}
+
+	ptr -= 4;
+	ptr[0] = (uint8_t)(x >> 0);
+	ptr[1] = (uint8_t)(x >> 8);
+	ptr[2] = (uint8_t)(x >> 16);
+	ptr[3] = (uint8_t)(x >> 24);
+
+	uint16_t encoded_len = end - ptr;
+	memcpy(data, ptr, encoded_len);
+
+	LOG_DBG("rans %u -> %u bytes", len, encoded_len);
+
+	return encoded_len;
+}
+
+int rans_encode(enum channel ch, enum quantize quant, uint8_t *data, uint16_t len)
+{
+	if (len == 0 || len > RANS_MAX_LEN) {
+		return -1;
+	}
+
+	k_mutex_lock(&rans_mutex, K_FOREVER);
+	int encoded_len = rans_encode_locked(ch, quant, data, len);
+	k_mutex_unlock(&rans_mutex);
+
+	return encoded_len;
+}
@@ -0,0 +1,649 @@
+#include "common.h"
+
+#include <zephyr/drivers/flash.h>
+#include <zephyr/storage/flash_map.h>
+
+LOG_MODULE_REGISTER(recorder);
+
+//
+// Sessions are recorded to the storage partition as an append-only log of the ring's own packet
+// records, so the host decodes them with the same parser. The partition is a circle of sectors,
+// each starting with a header that gives its sequence number, its session and the offset of the
+// first record starting in it; a session's records run on from one sector to the next. Sector
+// seq always lives at seq % count, so sectors are erased strictly in turn, which wears them all
+// evenly and overwrites the oldest data first. The session index is the list of sector headers,
+// read back at boot.
+//
+// The recorder thread copies committed packets out of the ring with a channel_reader and writes
+// them in RECORDER_BATCH_SIZE batches. Producers never wait for it: if flash falls behind, the
+// ring evicts as usual and the reader counts what it lost and picks up again at an anchor. A
+// session starts at the oldest anchor in the ring, so it includes what led up to the button press.
+//
+// The nRF52 CPU stalls while its flash is busy, ISRs included, and the sensor producers with it.
+// Each batch write takes 41 us per word, about 10.5 ms for RECORDER_BATCH_SIZE. That fits in
+// the 20 ms it takes the LIS3DH FIFO to fill at 1.6 kHz. An 85 ms page erase does not, so while
+// no session runs the thread keeps the next RECORDER_ERASE_AHEAD sectors erased, one per poll.
+// A session that outgrows them erases as it goes. With SOC_FLASH_NRF_PARTIAL_ERASE (see
+// app/Kconfig) the driver then erases in slices between radio events, so no stall is longer
+// than a few ms.
+//
+#define RECORDER_MAGIC         0x5243544b // "KTCR"
+#define RECORDER_BATCH_SIZE    1024
+#define RECORDER_ERASE_AHEAD   8
+#define RECORDER_WRITE_ALIGN   4
+#define RECORDER_POLL_MS       500
+#define RECORDER_BENCH_SECTORS 8
+#define RECORDER_DUMP_LINE     32
+
+struct recorder_sector {
+	uint32_t magic;
+	uint32_t seq;
+	uint32_t session;
+	uint16_t first_record;
+	uint16_t reserved;
+};
+
+const struct flash_area *recorder_area;
+uint32_t recorder_sector_size;
+uint32_t recorder_sector_count;
+uint32_t recorder_next_seq;
+uint32_t recorder_next_session;
+// Sectors from recorder_next_seq up to here are erased and waiting for a session.
+uint32_t recorder_erased_seq;
+
+K_MUTEX_DEFINE(recorder_lock);
+bool recorder_active;
+uint32_t recorder_session;
+uint32_t recorder_seq;
+uint32_t recorder_offset;
+
+// A batch is written as soon as RECORDER_BATCH_SIZE bytes are staged; what is left over, less
+// than one record, moves to the front. Records are staged whole, starting at recorder_record.
+uint8_t recorder_stage[2 * RECORDER_BATCH_SIZE] __aligned(4);
+uint16_t recorder_fill;
+uint16_t recorder_record;
+
+struct channel_reader recorder_reader;
+
+int64_t recorder_start_ms;
+int64_t recorder_stop_ms;
+uint32_t recorder_bytes;
+uint32_t recorder_batches;
+uint32_t recorder_erases;
+uint32_t recorder_wakeups;
+uint32_t recorder_flash_cycles;
+uint32_t recorder_errors;
+
+K_THREAD_STACK_DEFINE(recorder_thread_stack, 1024);
+struct k_thread recorder_thread;
+
+static uint32_t recorder_sector_offset(uint32_t seq)
+{
+	return (seq % recorder_sector_count) * recorder_sector_size;
+}
+
+// Sectors that were overwritten by a later trip around the partition, or by the benchmark,
+// don't carry the header for seq any more.
+static bool recorder_read_sector(uint32_t seq, struct recorder_sector *sector)
+{
+	if (flash_area_read(recorder_area, recorder_sector_offset(seq), sector, sizeof(*sector))) {
+		return false;
+	}
+	return sector->magic == RECORDER_MAGIC && sector->seq == seq;
+}
+
+static int recorder_open_sector(uint16_t first_record)
+{
+	uint32_t offset = recorder_sector_offset(recorder_next_seq);
+	struct recorder_sector sector = {
+		.magic = RECORDER_MAGIC,
+		.seq = recorder_next_seq,
+		.session = recorder_session,
+		.first_record = first_record,
+		.reserved = 0xFFFF,
+	};
+
+	uint32_t start = k_cycle_get_32();
+	int err = 0;
+	if (recorder_next_seq >= recorder_erased_seq) {
+		err = flash_area_erase(recorder_area, offset, recorder_sector_size);
+		recorder_erases++;
+	}
+	if (err == 0) {
+		err = flash_area_write(recorder_area, offset, &sector, sizeof(sector));
+	}
+	recorder_flash_cycles += k_cycle_get_32() - start;
+	if (err) {
+		return err;
+	}
+
+	recorder_seq = recorder_next_seq++;
+	recorder_erased_seq = MAX(recorder_erased_seq, recorder_next_seq);
+	recorder_offset = sizeof(sector);
+	return 0;
+}
+
+// Offset of the first staged record that starts at or after pos.
+static uint16_t recorder_record_at(uint16_t pos)
+{
+	uint16_t offset = recorder_record;
+	while (offset < pos) {
+		offset += channel_record_len(recorder_stage + offset);
+	}
+	return offset;
+}
+
+// Writes the first len staged bytes, opening sectors as they fill up.
+static int recorder_write(uint16_t len)
+{
+	for (uint16_t pos = 0; pos < len;) {
+		if (recorder_offset == recorder_sector_size) {
+			uint16_t first = recorder_record_at(pos) - pos;
+			int err = recorder_open_sector(sizeof(struct recorder_sector) + first);
+			if (err) {
+				return err;
+			}
+		}
+
+		uint16_t n = MIN(len - pos, recorder_sector_size - recorder_offset);
+		uint32_t offset = recorder_sector_offset(recorder_seq) + recorder_offset;
+
+		uint32_t start = k_cycle_get_32();
+		int err = flash_area_write(recorder_area, offset, recorder_stage + pos, n);
+		recorder_flash_cycles += k_cycle_get_32() - start;
+		if (err) {
+			return err;
+		}
+
+		recorder_offset += n;
+		pos += n;
+	}
+
+	recorder_record = recorder_record_at(len) - len;
+	recorder_fill -= len;
+	memmove(recorder_stage, recorder_stage + len, recorder_fill);
+	recorder_batches++;
+	return 0;
+}
+
+static int recorder_drain(void)
+{
+	for (;;) {
+		uint16_t len = channel_read_record(&recorder_reader, recorder_stage + recorder_fill,
+						   RECORDER_BATCH_SIZE);
+		if (len == 0) {
+			return 0;
+		}
+
+		recorder_fill += len;
+		recorder_bytes += len;
+		if (recorder_fill >= RECORDER_BATCH_SIZE) {
+			int err = recorder_write(RECORDER_BATCH_SIZE);
+			if (err) {
+				return err;
+			}
+		}
+	}
+}
+
+static void recorder_fail(int err)
+{
+	LOG_ERR("session %u: flash write failed: %d", recorder_session, err);
+	recorder_errors++;
+	recorder_active = false;
+	recorder_stop_ms = k_uptime_get();
+}
+
+static bool recorder_sector_blank(uint32_t seq)
+{
+	uint32_t base = recorder_sector_offset(seq);
+	uint32_t words[16];
+
+	for (uint32_t offset = 0; offset < recorder_sector_size; offset += sizeof(words)) {
+		if (flash_area_read(recorder_area, base + offset, words, sizeof(words))) {
+			return false;
+		}
+		for (int i = 0; i < ARRAY_SIZE(words); i++) {
+			if (words[i] != 0xFFFFFFFF) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// Erases the next sector a session will open, ahead of time. That overwrites the oldest data a
+// little early, but never wraps round to the newest.
+static void recorder_erase_ahead(void)
+{
+	uint32_t limit = recorder_next_seq + MIN(RECORDER_ERASE_AHEAD, recorder_sector_count - 1);
+
+	if (recorder_erased_seq >= limit) {
+		return;
+	}
+
+	uint32_t start = k_cycle_get_32();
+	int err = flash_area_erase(recorder_area, recorder_sector_offset(recorder_erased_seq),
+				   recorder_sector_size);
+	recorder_flash_cycles += k_cycle_get_32() - start;
+	if (err) {
+		LOG_ERR("erase of sector %u failed: %d", recorder_erased_seq, err);
+		recorder_errors++;
+		return;
+	}
+
+	recorder_erases++;
+	recorder_erased_seq++;
+}
+
+static void recorder_thread_main(void *, void *, void *)
+{
+	for (;;) {
+		k_msleep(RECORDER_POLL_MS);
+		recorder_wakeups++;
+
+		k_mutex_lock(&recorder_lock, K_FOREVER);
+		if (recorder_active) {
+			int err = recorder_drain();
+			if (err) {
+				recorder_fail(err);
+			}
+		} else {
+			recorder_erase_ahead();
+		}
+		k_mutex_unlock(&recorder_lock);
+	}
+}
+
+void recorder_init(void)
+{
+	struct flash_pages_info info;
+
+	int err = flash_area_open(FIXED_PARTITION_ID(storage_partition), &recorder_area);
+	if (err) {
+		LOG_ERR("storage partition not available: %d", err);
+		return;
+	}
+
+	const struct device *dev = flash_area_get_device(recorder_area);
+	err = flash_get_page_info_by_offs(dev, recorder_area->fa_off, &info);
+	if (err || recorder_area->fa_size % info.size != 0 ||
+	    RECORDER_WRITE_ALIGN % flash_get_write_block_size(dev) != 0) {
+		LOG_ERR("unsupported storage layout");
+		flash_area_close(recorder_area);
+		recorder_area = NULL;
+		return;
+	}
+	recorder_sector_size = info.size;
+	recorder_sector_count = recorder_area->fa_size / info.size;
+
+	// Carry on after the newest sector and session.
+	for (uint32_t i = 0; i < recorder_sector_count; i++) {
+		struct recorder_sector sector;
+		if (flash_area_read(recorder_area, i * recorder_sector_size, &sector,
+				    sizeof(sector)) ||
+		    sector.magic != RECORDER_MAGIC || sector.seq % recorder_sector_count != i) {
+			continue;
+		}
+		recorder_next_seq = MAX(recorder_next_seq, sector.seq + 1);
+		recorder_next_session = MAX(recorder_next_session, sector.session + 1);
+	}
+
+	// Sectors erased ahead before the reset are still blank.
+	recorder_erased_seq = recorder_next_seq;
+	while (recorder_erased_seq < recorder_next_seq + RECORDER_ERASE_AHEAD &&
+	       recorder_erased_seq < recorder_next_seq + recorder_sector_count - 1 &&
+	       recorder_sector_blank(recorder_erased_seq)) {
+		recorder_erased_seq++;
+	}
+
+	k_thread_create(&recorder_thread, recorder_thread_stack,
+			K_THREAD_STACK_SIZEOF(recorder_thread_stack), recorder_thread_main, NULL,
+			NULL, NULL, 10, 0, K_NO_WAIT);
+	k_thread_name_set(&recorder_thread, "recorder");
+
+	LOG_INF("initialized, %u sectors of %u bytes", recorder_sector_count, recorder_sector_size);
+}
+
+int recorder_start(void)
+{
+	if (recorder_area == NULL) {
+		return -ENODEV;
+	}
+
+	k_mutex_lock(&recorder_lock, K_FOREVER);
+	if (recorder_active) {
+		k_mutex_unlock(&recorder_lock);
+		return -EALREADY;
+	}
+
+	recorder_session = recorder_next_session++;
+	// The first write opens a sector, so sessions always start on a fresh one.
+	recorder_offset = recorder_sector_size;
+	recorder_fill = 0;
+	recorder_record = 0;
+	recorder_bytes = 0;
+	recorder_batches = 0;
+	recorder_erases = 0;
+	recorder_flash_cycles = 0;
+	recorder_start_ms = k_uptime_get();
+	channel_start_reader(&recorder_reader);
+	recorder_active = true;
+	energy_mark();
+	k_mutex_unlock(&recorder_lock);
+
+	LOG_INF("session %u started", recorder_session);
+	return 0;
+}
+
+void recorder_stop(void)
+{
+	k_mutex_lock(&recorder_lock, K_FOREVER);
+	if (!recorder_active) {
+		k_mutex_unlock(&recorder_lock);
+		return;
+	}
+
+	int err = recorder_drain();
+	if (err == 0 && recorder_fill % RECORDER_WRITE_ALIGN != 0) {
+		uint16_t pad = RECORDER_WRITE_ALIGN - recorder_fill % RECORDER_WRITE_ALIGN;
+		channel_padding_record(recorder_stage + recorder_fill, pad);
+		recorder_fill += pad;
+	}
+	if (err == 0 && recorder_fill > 0) {
+		err = recorder_write(recorder_fill);
+	}
+
+	if (err) {
+		recorder_fail(err);
+	} else {
+		recorder_active = false;
+		recorder_stop_ms = k_uptime_get();
+		LOG_INF("session %u stopped, %u bytes", recorder_session, recorder_bytes);
+	}
+	k_mutex_unlock(&recorder_lock);
+}
+
+int recorder_hold(void)
+{
+	k_mutex_lock(&recorder_lock, K_FOREVER);
+	if (recorder_active) {
+		k_mutex_unlock(&recorder_lock);
+		return -EBUSY;
+	}
+	return 0;
+}
+
+void recorder_release(void)
+{
+	k_mutex_unlock(&recorder_lock);
+}
+
+// Bytes of records in the sector, from the end of its header to the first erased record header.
+static uint32_t recorder_sector_used(uint32_t seq, struct recorder_sector *sector)
+{
+	uint32_t base = recorder_sector_offset(seq);
+	uint32_t offset = sector->first_record;
+
+	while (offset + 2 <= recorder_sector_size) {
+		uint8_t header[2];
+		if (flash_area_read(recorder_area, base + offset, header, sizeof(header)) ||
+		    (header[0] == 0xFF && header[1] == 0xFF)) {
+			break;
+		}
+		offset += channel_record_len(header);
+	}
+	return MIN(offset, recorder_sector_size) - sizeof(*sector);
+}
+
+// Finds the oldest surviving sector of a session and how many follow it.
+static bool recorder_find_session(uint32_t session, uint32_t *first_seq, uint32_t *sectors)
+{
+	uint32_t oldest = recorder_next_seq > recorder_sector_count
+				  ? recorder_next_seq - recorder_sector_count
+				  : 0;
+
+	*sectors = 0;
+	for (uint32_t seq = oldest; seq < recorder_next_seq; seq++) {
+		struct recorder_sector sector;
+		if (!recorder_read_sector(seq, &sector) || sector.session != session) {
+			continue;
+		}
+		if (*sectors == 0) {
+			*first_seq = seq;
+		}
+		(*sectors)++;
+	}
+	return *sectors > 0;
+}
+
+static int cmd_recorder_start(const struct shell *shell, size_t argc, char *argv[])
+{
+	int err = recorder_start();
+	if (err) {
+		shell_fprintf(shell, SHELL_ERROR, "can't start recording: %d\n", err);
+		return err;
+	}
+	shell_fprintf(shell, SHELL_NORMAL, "recording session %u\n", recorder_session);
+	return 0;
+}
+
+static int cmd_recorder_stop(const struct shell *shell, size_t argc, char *argv[])
+{
+	recorder_stop();
+	return 0;
+}
+
+static int cmd_recorder_status(const struct shell *shell, size_t argc, char *argv[])
+{
+	if (recorder_area == NULL) {
+		shell_fprintf(shell, SHELL_ERROR, "no storage partition\n");
+		return -ENODEV;
+	}
+
+	k_mutex_lock(&recorder_lock, K_FOREVER);
+
+	int64_t end = recorder_active ? k_uptime_get() : recorder_stop_ms;
+	uint32_t elapsed = end - recorder_start_ms;
+	uint64_t flash_us = k_cyc_to_us_floor64(recorder_flash_cycles);
+
+	shell_fprintf(shell, SHELL_NORMAL, "Recorder status:\n");
+	shell_fprintf(shell, SHELL_NORMAL, " partition: %u sectors of %u bytes, next seq %u\n",
+		      recorder_sector_count, recorder_sector_size, recorder_next_seq);
+	shell_fprintf(shell, SHELL_NORMAL, " session: %u %s, %u ms\n", recorder_session,
+		      recorder_active ? "recording" : "stopped", elapsed);
+	shell_fprintf(shell, SHELL_NORMAL,
+		      " data: bytes=%u (%u B/s) staged=%u batches=%u erases=%u\n", recorder_bytes,
+		      elapsed ? (uint32_t)((uint64_t)recorder_bytes * 1000 / elapsed) : 0,
+		      recorder_fill, recorder_batches, recorder_erases);
+	shell_fprintf(shell, SHELL_NORMAL,
+		      " flash: busy=%llu us (%.2f%%) erased_ahead=%u sectors errors=%u\n", flash_us,
+		      elapsed ? (double)flash_us / (elapsed * 10.0) : 0.0,
+		      recorder_erased_seq - MIN(recorder_erased_seq, recorder_next_seq),
+		      recorder_errors);
+	shell_fprintf(shell, SHELL_NORMAL, " ring: lost=%u packets\n", recorder_reader.lost);
+
+	k_mutex_unlock(&recorder_lock);
+	return 0;
+}
+
+static int cmd_recorder_list(const struct shell *shell, size_t argc, char *argv[])
+{
+	if (recorder_area == NULL) {
+		shell_fprintf(shell, SHELL_ERROR, "no storage partition\n");
+		return -ENODEV;
+	}
+
+	k_mutex_lock(&recorder_lock, K_FOREVER);
+
+	uint32_t oldest = recorder_next_seq > recorder_sector_count
+				  ? recorder_next_seq - recorder_sector_count
+				  : 0;
+	struct recorder_sector sector;
+	uint32_t session = 0;
+	uint32_t sectors = 0;
+	uint32_t bytes = 0;
+
+	// Sessions are runs of sectors; the last one's size is only known by walking it.
+	for (uint32_t seq = oldest; seq <= recorder_next_seq; seq++) {
+		bool valid = seq < recorder_next_seq && recorder_read_sector(seq, &sector);
+		if (sectors > 0 && (!valid || sector.session != session)) {
+			struct recorder_sector last;
+			recorder_read_sector(seq - 1, &last);
+			bytes += recorder_sector_used(seq - 1, &last);
+			shell_fprintf(shell, SHELL_NORMAL, "session %u: sectors=%u bytes=%u\n",
+				      session, sectors, bytes);
+			sectors = 0;
+			bytes = 0;
+		}
+		if (!valid) {
+			continue;
+		}
+		if (sectors > 0) {
+			bytes += recorder_sector_size - sizeof(sector);
+		}
+		session = sector.session;
+		sectors++;
+	}
+
+	k_mutex_unlock(&recorder_lock);
+	return 0;
+}
+
+// Prints a session's records as hex lines, from the first record boundary of its oldest
+// surviving sector; scripts/plot/packet.py parse_dump() turns them back into bytes.
+static int cmd_recorder_dump(const struct shell *shell, size_t argc, char *argv[])
+{
+	uint32_t session = strtoul(argv[1], NULL, 0);
+	uint32_t first_seq;
+	uint32_t sectors;
+
+	if (recorder_area == NULL) {
+		shell_fprintf(shell, SHELL_ERROR, "no storage partition\n");
+		return -ENODEV;
+	}
+
+	k_mutex_lock(&recorder_lock, K_FOREVER);
+
+	if (!recorder_find_session(session, &first_seq, &sectors)) {
+		k_mutex_unlock(&recorder_lock);
+		shell_fprintf(shell, SHELL_ERROR, "no session %u\n", session);
+		return -ENOENT;
+	}
+
+	for (uint32_t seq = first_seq; seq < first_seq + sectors; seq++) {
+		struct recorder_sector sector;
+		recorder_read_sector(seq, &sector);
+
+		uint32_t start = seq == first_seq ? sector.first_record : sizeof(sector);
+		uint32_t end = seq == first_seq + sectors - 1
+				       ? sizeof(sector) + recorder_sector_used(seq, &sector)
+				       : recorder_sector_size;
+
+		for (uint32_t offset = start; offset < end; offset += RECORDER_DUMP_LINE) {
+			uint8_t data[RECORDER_DUMP_LINE];
+			char hex[2 * RECORDER_DUMP_LINE + 1];
+			uint32_t n = MIN(end - offset, RECORDER_DUMP_LINE);
+
+			uint32_t base = recorder_sector_offset(seq);
+
+			flash_area_read(recorder_area, base + offset, data, n);
+			for (uint32_t i = 0; i < n; i++) {
+				snprintf(hex + 2 * i, 3, "%02X", data[i]);
+			}
+			shell_fprintf(shell, SHELL_NORMAL, "%s\n", hex);
+		}
+	}
+
+	k_mutex_unlock(&recorder_lock);
+	return 0;
+}
+
+// Erases and fills the next sectors in turn, the way a session would, and compares the
+// sustained throughput with the data rate of the last session. It overwrites the oldest sectors.
+static int cmd_recorder_bench(const struct shell *shell, size_t argc, char *argv[])
+{
+	uint32_t sectors = argc > 1 ? strtoul(argv[1], NULL, 0) : RECORDER_BENCH_SECTORS;
+	uint32_t erase_cycles = 0;
+	uint32_t write_cycles = 0;
+
+	if (recorder_area == NULL) {
+		shell_fprintf(shell, SHELL_ERROR, "no storage partition\n");
+		return -ENODEV;
+	}
+
+	k_mutex_lock(&recorder_lock, K_FOREVER);
+
+	if (recorder_active) {
+		k_mutex_unlock(&recorder_lock);
+		shell_fprintf(shell, SHELL_ERROR, "stop recording first\n");
+		return -EBUSY;
+	}
+
+	sectors = CLAMP(sectors, 1, recorder_sector_count);
+	memset(recorder_stage, 0xA5, RECORDER_BATCH_SIZE);
+
+	int err = 0;
+	for (uint32_t i = 0; i < sectors && err == 0; i++) {
+		uint32_t base = recorder_sector_offset(recorder_next_seq + i);
+
+		uint32_t start = k_cycle_get_32();
+		err = flash_area_erase(recorder_area, base, recorder_sector_size);
+		uint32_t erased = k_cycle_get_32();
+		for (uint32_t pos = 0; pos < recorder_sector_size && err == 0;
+		     pos += RECORDER_BATCH_SIZE) {
+			uint32_t n = MIN(RECORDER_BATCH_SIZE, recorder_sector_size - pos);
+			err = flash_area_write(recorder_area, base + pos, recorder_stage, n);
+		}
+		uint32_t end = k_cycle_get_32();
+
+		erase_cycles += erased - start;
+		write_cycles += end - erased;
+	}
+	// The thread erases them again in its own time.
+	recorder_erased_seq = recorder_next_seq;
+
+	if (err) {
+		k_mutex_unlock(&recorder_lock);
+		shell_fprintf(shell, SHELL_ERROR, "flash error: %d\n", err);
+		return err;
+	}
+
+	uint32_t bytes = sectors * recorder_sector_size;
+	uint64_t erase_us = k_cyc_to_us_floor64(erase_cycles);
+	uint64_t write_us = k_cyc_to_us_floor64(write_cycles);
+	uint32_t throughput = bytes * 1000000ull / MAX(erase_us + write_us, 1);
+
+	shell_fprintf(shell, SHELL_NORMAL,
+		      "flash: %u sectors, erase=%llu us/sector write=%llu us/KB, %u B/s\n", sectors,
+		      erase_us / sectors, write_us * 1024 / bytes, throughput);
+
+	uint32_t elapsed = recorder_stop_ms - recorder_start_ms;
+	if (recorder_bytes > 0 && elapsed > 0) {
+		uint32_t rate = (uint64_t)recorder_bytes * 1000 / elapsed;
+		uint32_t capacity = (uint64_t)(recorder_sector_count * recorder_sector_size) /
+				    MAX(rate, 1);
+
+		shell_fprintf(shell, SHELL_NORMAL,
+			      "session %u: %u B/s, %.1fx headroom, partition holds %u s\n",
+			      recorder_session, rate, (double)throughput / MAX(rate, 1), capacity);
+	} else {
+		shell_fprintf(shell, SHELL_NORMAL, "record a session to compare its data rate\n");
+	}
+
+	k_mutex_unlock(&recorder_lock);
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(
+	recorder_cmds,
+	SHELL_CMD_ARG(bench, NULL, "time flash erase and write [sectors]", cmd_recorder_bench, 1,
+		      1),
+	SHELL_CMD_ARG(dump, NULL, "print a session's records as hex", cmd_recorder_dump, 2, 0),
+	SHELL_CMD_ARG(list, NULL, "list recorded sessions", cmd_recorder_list, 1, 0),
+	SHELL_CMD_ARG(start, NULL, "start a session", cmd_recorder_start, 1, 0),
+	SHELL_CMD_ARG(status, NULL, "print recorder status", cmd_recorder_status, 1, 0),
+	SHELL_CMD_ARG(stop, NULL, "stop the session", cmd_recorder_stop, 1, 0),
+	SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(recorder, &recorder_cmds, "Flash session recorder", NULL);
@@ -0,0 +1,188 @@
+#include "common.h"
+
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+
+#include <SEGGER_RTT.h>
+
+LOG_MODULE_REGISTER(rtt);
+
+//
+// Binary packet stream on its own RTT up-buffer, next to the shell on buffer 0. Every ring packet
+// record goes out as one frame:
+//
+//   COBS(seq:16 | record | crc:16) 0x00
+//
+// COBS keeps zero bytes out of the frame, so a reader can start or resync at any 0x00. seq
+// counts packets: it advances by one per frame, plus one per packet the drain lost to ring
+// eviction or dropped itself, so a gap in seq on the host is exactly what is missing. The CRC is
+// CRC-16/KERMIT (crc16_ccitt() seeded with 0) over seq and the record, little endian.
+// scripts/plot/rtt_reader.py decodes it.
+//
+// The drain thread runs at the lowest priority and never makes RTT block. While a host is
+// reading the buffer, a frame that doesn't fit waits for room, so nothing is dropped here and a
+// slow host shows up as ring eviction. Without a host, frames that don't fit are dropped, so the
+// buffer keeps the oldest ones for whoever attaches. A host counts as attached once the buffer
+// level drops, and as gone once the buffer has sat full for RTT_DETACH_MS.
+//
+#define RTT_FRAME_BUFFER 1
+#define RTT_BUFFER_SIZE  2048
+#define RTT_RECORD_SIZE  1024
+#define RTT_POLL_MS      10
+#define RTT_DETACH_MS    1000
+
+// seq and crc around the record, then one COBS code byte per 254 bytes and the delimiter.
+#define RTT_FRAME_DATA_SIZE (2 + RTT_RECORD_SIZE + 2)
+#define RTT_FRAME_SIZE      (RTT_FRAME_DATA_SIZE + RTT_FRAME_DATA_SIZE / 254 + 2)
+
+uint8_t rtt_buffer[RTT_BUFFER_SIZE];
+
+struct channel_reader rtt_reader;
+uint8_t rtt_data[RTT_FRAME_DATA_SIZE];
+uint8_t rtt_frame[RTT_FRAME_SIZE];
+uint16_t rtt_frame_len;
+
+uint16_t rtt_seq;
+uint32_t rtt_lost;
+
+bool rtt_attached;
+unsigned rtt_level;
+int64_t rtt_read_ms;
+
+uint32_t rtt_frames;
+uint32_t rtt_bytes;
+uint32_t rtt_dropped;
+uint32_t rtt_waits;
+uint32_t rtt_wakeups;
+int64_t rtt_start_ms;
+
+K_THREAD_STACK_DEFINE(rtt_thread_stack, 1024);
+struct k_thread rtt_thread;
+
+// Consistent overhead byte stuffing, followed by the 0x00 delimiter.
+static uint16_t rtt_cobs_encode(const uint8_t *src, uint16_t len, uint8_t *dst)
+{
+	uint16_t code_pos = 0;
+	uint16_t out = 1;
+	uint8_t code = 1;
+
+	for (uint16_t i = 0; i < len; i++) {
+		if (src[i] != 0) {
+			dst[out++] = src[i];
+			code++;
+		}
+		if (src[i] == 0 || code == 0xFF) {
+			dst[code_pos] = code;
+			code_pos = out++;
+			code = 1;
+		}
+	}
+	dst[code_pos] = code;
+	dst[out++] = 0;
+	return out;
+}
+
+// Frames the next record from the ring, or returns false if there is none.
+static bool rtt_next_frame(void)
+{
+	uint16_t len = channel_read_record(&rtt_reader, rtt_data + 2, RTT_RECORD_SIZE);
+	if (len == 0) {
+		return false;
+	}
+
+	rtt_seq += rtt_reader.lost - rtt_lost;
+	rtt_lost = rtt_reader.lost;
+
+	sys_put_le16(rtt_seq++, rtt_data);
+	sys_put_le16(crc16_ccitt(0, rtt_data, 2 + len), rtt_data + 2 + len);
+	rtt_frame_len = rtt_cobs_encode(rtt_data, 2 + len + 2, rtt_frame);
+	return true;
+}
+
+static void rtt_check_host(int64_t now)
+{
+	unsigned level = SEGGER_RTT_GetBytesInBuffer(RTT_FRAME_BUFFER);
+
+	if (level < rtt_level) {
+		rtt_read_ms = now;
+		if (!rtt_attached) {
+			rtt_attached = true;
+			LOG_INF("host attached");
+		}
+	} else if (rtt_attached && level > 0 && now - rtt_read_ms > RTT_DETACH_MS) {
+		rtt_attached = false;
+		LOG_INF("host gone");
+	}
+	rtt_level = level;
+}
+
+static void rtt_thread_main(void *, void *, void *)
+{
+	for (;;) {
+		k_msleep(RTT_POLL_MS);
+		rtt_wakeups++;
+		rtt_check_host(k_uptime_get());
+
+		for (;;) {
+			if (rtt_frame_len == 0 && !rtt_next_frame()) {
+				break;
+			}
+
+			if (SEGGER_RTT_GetAvailWriteSpace(RTT_FRAME_BUFFER) < rtt_frame_len) {
+				if (rtt_attached) {
+					rtt_waits++;
+					break;
+				}
+				rtt_dropped++;
+			} else {
+				SEGGER_RTT_Write(RTT_FRAME_BUFFER, rtt_frame, rtt_frame_len);
+				rtt_frames++;
+				rtt_bytes += rtt_frame_len;
+			}
+			rtt_frame_len = 0;
+		}
+
+		rtt_level = SEGGER_RTT_GetBytesInBuffer(RTT_FRAME_BUFFER);
+	}
+}
+
+void rtt_init(void)
+{
+	int err = SEGGER_RTT_ConfigUpBuffer(RTT_FRAME_BUFFER, "packets", rtt_buffer,
+					    sizeof(rtt_buffer), SEGGER_RTT_MODE_NO_BLOCK_SKIP);
+	if (err < 0) {
+		LOG_ERR("can't configure up-buffer %d: %d", RTT_FRAME_BUFFER, err);
+		return;
+	}
+
+	channel_start_reader(&rtt_reader);
+	rtt_start_ms = k_uptime_get();
+
+	k_thread_create(&rtt_thread, rtt_thread_stack, K_THREAD_STACK_SIZEOF(rtt_thread_stack),
+			rtt_thread_main, NULL, NULL, NULL, 14, 0, K_NO_WAIT);
+	k_thread_name_set(&rtt_thread, "rtt");
+}
+
+static int cmd_rtt_status(const struct shell *shell, size_t argc, char *argv[])
+{
+	uint32_t elapsed = k_uptime_get() - rtt_start_ms;
+
+	shell_fprintf(shell, SHELL_NORMAL, "RTT status:\n");
+	shell_fprintf(shell, SHELL_NORMAL, " buffer %d: %u/%u bytes, host %s\n", RTT_FRAME_BUFFER,
+		      SEGGER_RTT_GetBytesInBuffer(RTT_FRAME_BUFFER), RTT_BUFFER_SIZE,
+		      rtt_attached ? "attached" : "not attached");
+	shell_fprintf(shell, SHELL_NORMAL, " frames=%u (%u/s) bytes=%u (%u B/s) seq=%u\n",
+		      rtt_frames, elapsed ? (uint32_t)((uint64_t)rtt_frames * 1000 / elapsed) : 0,
+		      rtt_bytes, elapsed ? (uint32_t)((uint64_t)rtt_bytes * 1000 / elapsed) : 0,
+		      rtt_seq);
+	shell_fprintf(shell, SHELL_NORMAL, " dropped=%u waits=%u lost=%u packets\n", rtt_dropped,
+		      rtt_waits, rtt_reader.lost);
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(rtt_cmds,
+			       SHELL_CMD_ARG(status, NULL, "print RTT packet stream status",
+					     cmd_rtt_status, 1, 0),
+			       SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(rtt, &rtt_cmds, "RTT packet stream", NULL);
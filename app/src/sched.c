@@ -0,0 +1,174 @@
+#include "common.h"
+
+LOG_MODULE_REGISTER(sched);
+
+#define SCHED_MAX_SENSORS 4
+// Sensors with nothing to model (powered down) are still checked this often.
+#define SCHED_IDLE_MS     1000
+
+#define SCHED_KICK  0
+#define SCHED_CONFIG 1
+
+K_SEM_DEFINE(sched_sem, 0, 1);
+// Set by sched_stop(), checked between services.
+atomic_t sched_stopping;
+
+struct sched_sensor *sched_sensors[SCHED_MAX_SENSORS];
+uint8_t sched_sensor_count;
+
+uint32_t sched_wakeups;
+
+K_THREAD_STACK_DEFINE(sched_thread_stack, 1280);
+struct k_thread sched_thread;
+
+// The sensor's oscillator can run fast of its nominal rate, so the faster of the model and what
+// was actually drained is planned for.
+static uint32_t sched_rate(struct sched_sensor *s)
+{
+	return MAX(s->fill_rate(), s->observed_rate);
+}
+
+// Plans the next deadline for when the FIFO will have filled to its watermark again.
+static void sched_plan(struct sched_sensor *s, int64_t now)
+{
+	uint32_t rate = sched_rate(s);
+
+	s->last_ms = now;
+	s->period_ms = rate ? (uint64_t)s->watermark * 1000000 / rate : SCHED_IDLE_MS;
+	s->deadline_ms = now + MAX(s->period_ms, 1);
+}
+
+static void sched_service(struct sched_sensor *s, int64_t now)
+{
+	PERF_START(t);
+	int entries = s->service();
+	PERF_END(PERF_SERVICE, t, MAX(entries, 0));
+	if (entries < 0) {
+		LOG_ERR("%s: service failed: %d", s->name, entries);
+		entries = 0;
+	}
+
+	uint32_t elapsed = now - s->last_ms;
+	if (entries > 0 && elapsed > 0) {
+		int32_t observed = (uint64_t)entries * 1000000 / elapsed;
+		s->observed_rate += (observed - (int32_t)s->observed_rate) / 4;
+	}
+
+	s->services++;
+	s->max_fill = MAX(s->max_fill, entries);
+	sched_plan(s, now);
+}
+
+// Sleeps until the earliest deadline or a kick, then services every sensor that is due, kicked,
+// or at least halfway to its watermark, so sensors running at similar rates share wakeups.
+// Returns between services once stopped: each service waits for its own SPI bursts, so none is
+// in flight then, and what a sensor kept back for its next service is flushed.
+static void sched_thread_main(void *, void *, void *)
+{
+	while (!atomic_get(&sched_stopping)) {
+		int64_t next = k_uptime_get() + SCHED_IDLE_MS;
+		for (int i = 0; i < sched_sensor_count; i++) {
+			next = MIN(next, sched_sensors[i]->deadline_ms);
+		}
+
+		k_sem_take(&sched_sem, K_TIMEOUT_ABS_MS(next));
+		sched_wakeups++;
+
+		int64_t now = k_uptime_get();
+		for (int i = 0; i < sched_sensor_count && !atomic_get(&sched_stopping); i++) {
+			struct sched_sensor *s = sched_sensors[i];
+
+			// New settings are applied between services, so none sees half of them. A
+			// reconfigured sensor has a new rate and, for most, an emptied FIFO.
+			if (atomic_test_and_clear_bit(&s->flags, SCHED_CONFIG)) {
+				s->config();
+				s->observed_rate = 0;
+				sched_plan(s, k_uptime_get());
+				continue;
+			}
+
+			if (atomic_test_and_clear_bit(&s->flags, SCHED_KICK)) {
+				s->kicked++;
+			} else if (now >= s->deadline_ms) {
+				s->due++;
+			} else if (now >= s->deadline_ms - s->period_ms / 2) {
+				s->coalesced++;
+			} else {
+				continue;
+			}
+			sched_service(s, now);
+		}
+	}
+
+	for (int i = 0; i < sched_sensor_count; i++) {
+		if (sched_sensors[i]->flush) {
+			sched_sensors[i]->flush();
+		}
+	}
+}
+
+void sched_register(struct sched_sensor *sensor)
+{
+	if (sched_sensor_count == SCHED_MAX_SENSORS) {
+		LOG_ERR("too many sensors");
+		k_oops();
+	}
+
+	sched_plan(sensor, k_uptime_get());
+	sched_sensors[sched_sensor_count++] = sensor;
+}
+
+void sched_kick(struct sched_sensor *sensor)
+{
+	atomic_set_bit(&sensor->flags, SCHED_KICK);
+	k_sem_give(&sched_sem);
+}
+
+void sched_reconfigure(struct sched_sensor *sensor)
+{
+	atomic_set_bit(&sensor->flags, SCHED_CONFIG);
+	k_sem_give(&sched_sem);
+}
+
+void sched_init(void)
+{
+	k_thread_create(&sched_thread, sched_thread_stack,
+			K_THREAD_STACK_SIZEOF(sched_thread_stack), sched_thread_main, NULL, NULL,
+			NULL, 7, 0, K_NO_WAIT);
+	k_thread_name_set(&sched_thread, "sched");
+}
+
+void sched_stop(void)
+{
+	atomic_set(&sched_stopping, 1);
+	k_sem_give(&sched_sem);
+	k_thread_join(&sched_thread, K_FOREVER);
+}
+
+static int cmd_sched_status(const struct shell *shell, size_t argc, char *argv[])
+{
+	uint32_t services = 0;
+
+	shell_fprintf(shell, SHELL_NORMAL, "Scheduler status:\n");
+	for (int i = 0; i < sched_sensor_count; i++) {
+		struct sched_sensor *s = sched_sensors[i];
+		uint32_t model = s->fill_rate();
+
+		shell_fprintf(shell, SHELL_NORMAL,
+			      " %s: model=%u.%03u/s observed=%u.%03u/s period=%u ms fill=%u/%u\n",
+			      s->name, model / 1000, model % 1000, s->observed_rate / 1000,
+			      s->observed_rate % 1000, s->period_ms, s->max_fill, s->depth);
+		shell_fprintf(shell, SHELL_NORMAL, "  services=%u kicked=%u due=%u coalesced=%u\n",
+			      s->services, s->kicked, s->due, s->coalesced);
+		services += s->services;
+	}
+	shell_fprintf(shell, SHELL_NORMAL, " wakeups=%u services=%u\n", sched_wakeups, services);
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sched_cmds,
+			       SHELL_CMD_ARG(status, NULL, "print scheduler status",
+					     cmd_sched_status, 1, 0),
+			       SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(sched, &sched_cmds, "Sensor FIFO scheduler", NULL);
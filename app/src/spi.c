@@ -1,5 +1,20 @@
 #include "common.h"
 
+// Every chip-select cycle, for comparing how chatty the drivers are, and per device (by chip
+// select) for the energy model.
+uint32_t spi_transactions;
+struct spi_device_stats spi_device_stats[SPI_MAX_DEVICES];
+
+static void spi_count(const struct spi_dt_spec *spec, uint16_t bytes)
+{
+    uint16_t device = MIN(spec->config.slave, SPI_MAX_DEVICES - 1);
+    struct spi_device_stats *stats = &spi_device_stats[device];
+
+    spi_transactions++;
+    stats->transactions++;
+    stats->bytes += bytes;
+}
+
 void spi_write_uint8(const struct spi_dt_spec *spec, uint8_t reg, uint8_t val)
 {
     uint8_t tx_buf[2] = {reg, val};
@@ -7,7 +22,10 @@ void spi_write_uint8(const struct spi_dt_spec *spec, uint8_t reg, uint8_t val)
     const struct spi_buf tx = {.buf = tx_buf, .len = 2};
     const struct spi_buf_set txs = {.buffers = &tx, .count = 1};
 
+    PERF_START(t);
     spi_write_dt(spec, &txs);
+    PERF_END(PERF_SPI_REG, t, 2);
+    spi_count(spec, 2);
 }
 
 uint8_t spi_read_uint8(const struct spi_dt_spec *spec, uint8_t reg)
@@ -20,7 +38,102 @@ uint8_t spi_read_uint8(const struct spi_dt_spec *spec, uint8_t reg)
     const struct spi_buf_set txs = {.buffers = &tx, .count = 1};
     const struct spi_buf_set rxs = {.buffers = &rx, .count = 1};
 
+    PERF_START(t);
     spi_transceive_dt(spec, &txs, &rxs);
+    PERF_END(PERF_SPI_REG, t, 2);
+    spi_count(spec, 2);
 
     return rx_buf[1];
 }
+
+// Reads len consecutive registers from reg in one auto-incrementing burst.
+int spi_read_buf(const struct spi_dt_spec *spec, uint8_t reg, uint16_t len, uint8_t *buf)
+{
+    uint8_t cmd = reg | 0x80;
+
+    // The byte clocked in during the command is dropped.
+    const struct spi_buf tx = {.buf = &cmd, .len = 1};
+    const struct spi_buf rx[2] = {{.buf = NULL, .len = 1}, {.buf = buf, .len = len}};
+    const struct spi_buf_set txs = {.buffers = &tx, .count = 1};
+    const struct spi_buf_set rxs = {.buffers = rx, .count = 2};
+
+    spi_count(spec, 1 + len);
+    PERF_START(t);
+    int err = spi_transceive_dt(spec, &txs, &rxs);
+    PERF_END(PERF_SPI_REG, t, 1 + len);
+    return err;
+}
+
+// Async burst reads into a pair of static buffers. While EasyDMA fills one, the caller still
+// owns the other, so it can decode the previous read without stalling on the bus. Without
+// CONFIG_SPI_ASYNC the transfer runs synchronously and completes immediately.
+
+#ifdef CONFIG_SPI_ASYNC
+static void spi_stream_done(const struct device *dev, int result, void *data)
+{
+    struct spi_stream *stream = data;
+
+    stream->result = result;
+    stream->busy_cycles += k_cycle_get_32() - stream->start_cycles;
+    k_sem_give(&stream->done);
+}
+#endif
+
+int spi_stream_start(const struct spi_dt_spec *spec, struct spi_stream *stream, uint8_t cmd,
+                     uint16_t len)
+{
+    if (stream->busy || len > stream->size) {
+        return -EINVAL;
+    }
+
+    stream->cmd = cmd;
+    stream->len = len;
+    // The byte clocked in during the command is dropped, so data starts buffer aligned.
+    stream->tx = (struct spi_buf){.buf = &stream->cmd, .len = 1};
+    stream->rx[0] = (struct spi_buf){.buf = NULL, .len = 1};
+    stream->rx[1] = (struct spi_buf){.buf = stream->bufs[stream->fill], .len = len};
+    stream->txs = (struct spi_buf_set){.buffers = &stream->tx, .count = 1};
+    stream->rxs = (struct spi_buf_set){.buffers = stream->rx, .count = 2};
+    stream->busy = true;
+    stream->transfers++;
+    spi_count(spec, 1 + len);
+    stream->bytes += 1 + len;
+    stream->start_cycles = k_cycle_get_32();
+#ifdef CONFIG_APP_PERF
+    stream->perf_start = perf_cycles();
+#endif
+
+#ifdef CONFIG_SPI_ASYNC
+    int err = spi_transceive_cb(spec->bus, &spec->config, &stream->txs, &stream->rxs,
+                                spi_stream_done, stream);
+    if (err) {
+        stream->busy = false;
+    }
+    return err;
+#else
+    stream->result = spi_transceive_dt(spec, &stream->txs, &stream->rxs);
+    stream->busy_cycles += k_cycle_get_32() - stream->start_cycles;
+    return 0;
+#endif
+}
+
+uint8_t *spi_stream_wait(struct spi_stream *stream)
+{
+    if (!stream->busy) {
+        return NULL;
+    }
+
+#ifdef CONFIG_SPI_ASYNC
+    k_sem_take(&stream->done, K_FOREVER);
+#endif
+
+    stream->busy = false;
+    PERF_END(PERF_SPI_BURST, stream->perf_start, 1 + stream->len);
+    if (stream->result) {
+        return NULL;
+    }
+
+    uint8_t *buf = stream->bufs[stream->fill];
+    stream->fill ^= 1;
+    return buf;
+}
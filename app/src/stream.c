@@ -0,0 +1,432 @@
+#include "common.h"
+
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/gatt.h>
+#include <zephyr/bluetooth/hci.h>
+
+LOG_MODULE_REGISTER(stream);
+
+//
+// Live streaming of the channel ring over BLE. A central that subscribes to the TX
+// characteristic of the NUS-style service gets the ring's packet records as one byte stream,
+// starting at the oldest anchor: each notification is filled up to the ATT MTU, and records run
+// on from one notification to the next, so the host just concatenates them and walks the records
+// with packet.py. Notifications on a connection arrive in order and complete, so the only gaps
+// are packets the ring evicted before they were sent, which the reader counts and skips to the
+// next anchor for.
+//
+// On connection the peripheral asks for 2M PHY, the longest data length, the largest MTU and a
+// short connection interval; whatever is granted is used. At most STREAM_CREDITS notifications
+// are queued in the stack at a time, so a slow link shows up as stalls here instead of taking
+// every TX buffer.
+//
+#define STREAM_CREDITS     4
+#define STREAM_POLL_MS     20
+#define STREAM_RECORD_SIZE 1024
+#define STREAM_PAYLOAD_MAX (CONFIG_BT_L2CAP_TX_MTU - 3)
+// ATT opcode and handle, L2CAP length and channel.
+#define STREAM_HEADER_LEN  7
+
+// 7.5 to 15 ms interval, no latency, 4 s supervision timeout.
+#define STREAM_CONN_PARAM BT_LE_CONN_PARAM(6, 12, 0, 400)
+
+// On-air costs for the radio-on estimate, see stream_radio_us(). Per LL PDU: preamble, access
+// address, header and CRC; T_IFS between PDUs; ramp-up once per connection event. An empty event
+// is the central's poll and our empty reply. BT_LE_ADV_CONN_FAST_1 advertises every 30 to 60 ms,
+// each event an ADV_IND on three channels with a listen after each.
+#define STREAM_LL_OVERHEAD     10
+#define STREAM_IFS_US          150
+#define STREAM_EVENT_US        450
+#define STREAM_ADV_EVENT_US    2000
+#define STREAM_ADV_INTERVAL_MS 50
+
+#define STREAM_SUBSCRIBED 0
+#define STREAM_RESTART    1
+
+#define BT_UUID_NUS_SERVICE_VAL                                                                    \
+	BT_UUID_128_ENCODE(0x6E400001, 0xB5A3, 0xF393, 0xE0A9, 0xE50E24DCCA9E)
+#define BT_UUID_NUS_TX_VAL                                                                         \
+	BT_UUID_128_ENCODE(0x6E400003, 0xB5A3, 0xF393, 0xE0A9, 0xE50E24DCCA9E)
+
+static struct bt_uuid_128 stream_uuid = BT_UUID_INIT_128(BT_UUID_NUS_SERVICE_VAL);
+static struct bt_uuid_128 stream_tx_uuid = BT_UUID_INIT_128(BT_UUID_NUS_TX_VAL);
+
+static const struct bt_data stream_ad[] = {
+	BT_DATA_BYTES(BT_DATA_FLAGS, (BT_LE_AD_GENERAL | BT_LE_AD_NO_BREDR)),
+	BT_DATA(BT_DATA_NAME_COMPLETE, CONFIG_BT_DEVICE_NAME, sizeof(CONFIG_BT_DEVICE_NAME) - 1),
+};
+
+static const struct bt_data stream_sd[] = {
+	BT_DATA_BYTES(BT_DATA_UUID128_ALL, BT_UUID_NUS_SERVICE_VAL),
+};
+
+K_SPINLOCK_DEFINE(stream_lock);
+struct bt_conn *stream_conn;
+atomic_t stream_flags;
+K_SEM_DEFINE(stream_wake, 0, 1);
+
+// Completions from an earlier subscription are ignored, they were counted out on restart.
+atomic_t stream_inflight;
+uint32_t stream_generation;
+
+struct channel_reader stream_reader;
+uint8_t stream_record[STREAM_RECORD_SIZE];
+uint16_t stream_record_len;
+uint16_t stream_record_pos;
+uint8_t stream_payload[STREAM_PAYLOAD_MAX];
+uint16_t stream_fill;
+
+uint16_t stream_mtu;
+uint8_t stream_tx_phy;
+uint16_t stream_tx_len;
+uint16_t stream_interval;
+
+int64_t stream_start_ms;
+uint32_t stream_bytes;
+uint32_t stream_notifications;
+uint32_t stream_stalls;
+uint32_t stream_errors;
+
+int64_t stream_enable_ms;
+int64_t stream_connect_ms;
+uint64_t stream_connected_ms;
+uint64_t stream_air_us;
+uint32_t stream_wakeups;
+
+K_THREAD_STACK_DEFINE(stream_thread_stack, 1280);
+struct k_thread stream_thread;
+
+static void stream_adv_start(struct k_work *work)
+{
+	int err = bt_le_adv_start(BT_LE_ADV_CONN_FAST_1, stream_ad, ARRAY_SIZE(stream_ad),
+				  stream_sd, ARRAY_SIZE(stream_sd));
+	if (err) {
+		LOG_ERR("advertising failed to start: %d", err);
+	}
+}
+
+K_WORK_DEFINE(stream_adv_work, stream_adv_start);
+
+static void stream_ccc_changed(const struct bt_gatt_attr *attr, uint16_t value)
+{
+	if (value == BT_GATT_CCC_NOTIFY) {
+		atomic_set_bit(&stream_flags, STREAM_RESTART);
+		atomic_set_bit(&stream_flags, STREAM_SUBSCRIBED);
+		k_sem_give(&stream_wake);
+	} else {
+		atomic_clear_bit(&stream_flags, STREAM_SUBSCRIBED);
+	}
+	LOG_INF("notifications %s", value == BT_GATT_CCC_NOTIFY ? "enabled" : "disabled");
+}
+
+BT_GATT_SERVICE_DEFINE(stream_svc, BT_GATT_PRIMARY_SERVICE(&stream_uuid),
+		       BT_GATT_CHARACTERISTIC(&stream_tx_uuid.uuid, BT_GATT_CHRC_NOTIFY,
+					      BT_GATT_PERM_NONE, NULL, NULL, NULL),
+		       BT_GATT_CCC(stream_ccc_changed, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE));
+
+static void stream_mtu_exchanged(struct bt_conn *conn, uint8_t err,
+				 struct bt_gatt_exchange_params *params)
+{
+	stream_mtu = bt_gatt_get_mtu(conn);
+	LOG_INF("mtu %u%s", stream_mtu, err ? " (exchange failed)" : "");
+}
+
+static struct bt_gatt_exchange_params stream_mtu_params = {
+	.func = stream_mtu_exchanged,
+};
+
+static void stream_connected(struct bt_conn *conn, uint8_t err)
+{
+	if (err) {
+		LOG_ERR("connection failed: 0x%02x", err);
+		return;
+	}
+
+	k_spinlock_key_t key = k_spin_lock(&stream_lock);
+	stream_conn = bt_conn_ref(conn);
+	k_spin_unlock(&stream_lock, key);
+
+	struct bt_conn_info info;
+	if (bt_conn_get_info(conn, &info) == 0) {
+		stream_interval = info.le.interval;
+	}
+	stream_connect_ms = k_uptime_get();
+	stream_mtu = bt_gatt_get_mtu(conn);
+	LOG_INF("connected");
+
+	// Each of these is only a request; failures leave the link slower but working.
+	err = bt_conn_le_phy_update(conn, BT_CONN_LE_PHY_PARAM_2M);
+	if (err) {
+		LOG_WRN("phy update failed: %d", err);
+	}
+	err = bt_conn_le_data_len_update(conn, BT_LE_DATA_LEN_PARAM_MAX);
+	if (err) {
+		LOG_WRN("data length update failed: %d", err);
+	}
+	err = bt_gatt_exchange_mtu(conn, &stream_mtu_params);
+	if (err) {
+		LOG_WRN("mtu exchange failed: %d", err);
+	}
+	err = bt_conn_le_param_update(conn, STREAM_CONN_PARAM);
+	if (err) {
+		LOG_WRN("connection parameter update failed: %d", err);
+	}
+}
+
+static void stream_disconnected(struct bt_conn *conn, uint8_t reason)
+{
+	k_spinlock_key_t key = k_spin_lock(&stream_lock);
+	struct bt_conn *old = stream_conn;
+	stream_conn = NULL;
+	k_spin_unlock(&stream_lock, key);
+
+	if (old) {
+		stream_connected_ms += k_uptime_get() - stream_connect_ms;
+	}
+	atomic_clear_bit(&stream_flags, STREAM_SUBSCRIBED);
+	if (old) {
+		bt_conn_unref(old);
+	}
+	LOG_INF("disconnected: 0x%02x", reason);
+}
+
+static void stream_recycled(void)
+{
+	k_work_submit(&stream_adv_work);
+}
+
+static void stream_param_updated(struct bt_conn *conn, uint16_t interval, uint16_t latency,
+				 uint16_t timeout)
+{
+	stream_interval = interval;
+	LOG_INF("interval %u.%02u ms, latency %u", interval * 5 / 4, interval * 125 % 100, latency);
+}
+
+static void stream_phy_updated(struct bt_conn *conn, struct bt_conn_le_phy_info *param)
+{
+	stream_tx_phy = param->tx_phy;
+	LOG_INF("phy tx=%u rx=%u", param->tx_phy, param->rx_phy);
+}
+
+static void stream_data_len_updated(struct bt_conn *conn, struct bt_conn_le_data_len_info *info)
+{
+	stream_tx_len = info->tx_max_len;
+	LOG_INF("data length tx=%u rx=%u", info->tx_max_len, info->rx_max_len);
+}
+
+BT_CONN_CB_DEFINE(stream_conn_cbs) = {
+	.connected = stream_connected,
+	.disconnected = stream_disconnected,
+	.recycled = stream_recycled,
+	.le_param_updated = stream_param_updated,
+	.le_phy_updated = stream_phy_updated,
+	.le_data_len_updated = stream_data_len_updated,
+};
+
+static void stream_sent(struct bt_conn *conn, void *user_data)
+{
+	if ((uintptr_t)user_data == stream_generation) {
+		atomic_dec(&stream_inflight);
+	}
+	k_sem_give(&stream_wake);
+}
+
+static void stream_restart(void)
+{
+	stream_generation++;
+	atomic_set(&stream_inflight, 0);
+	channel_start_reader(&stream_reader);
+	stream_record_len = 0;
+	stream_record_pos = 0;
+	stream_fill = 0;
+	stream_start_ms = k_uptime_get();
+	stream_bytes = 0;
+	stream_notifications = 0;
+	stream_stalls = 0;
+	stream_errors = 0;
+}
+
+// Tops up the notification payload from the ring, splitting records where it fills up.
+static void stream_fill_payload(uint16_t size)
+{
+	while (stream_fill < size) {
+		if (stream_record_pos == stream_record_len) {
+			stream_record_len = channel_read_record(&stream_reader, stream_record,
+								sizeof(stream_record));
+			stream_record_pos = 0;
+			if (stream_record_len == 0) {
+				return;
+			}
+		}
+
+		uint16_t n = MIN(size - stream_fill, stream_record_len - stream_record_pos);
+		memcpy(stream_payload + stream_fill, stream_record + stream_record_pos, n);
+		stream_fill += n;
+		stream_record_pos += n;
+	}
+}
+
+// Air time of one notification: its ATT and L2CAP headers and payload in LL fragments of the
+// negotiated data length, each acked by an empty PDU.
+static uint32_t stream_notify_air_us(uint16_t len)
+{
+	uint32_t us_per_byte = stream_tx_phy == BT_GAP_LE_PHY_2M ? 4 : 8;
+	uint16_t tx_len = stream_tx_len ? stream_tx_len : 27;
+	uint32_t bytes = STREAM_HEADER_LEN + len;
+	uint32_t fragments = DIV_ROUND_UP(bytes, tx_len);
+
+	return (bytes + fragments * 2 * STREAM_LL_OVERHEAD) * us_per_byte +
+	       fragments * 2 * STREAM_IFS_US;
+}
+
+uint64_t stream_radio_us(void)
+{
+	if (stream_enable_ms == 0) {
+		return 0;
+	}
+
+	int64_t now = k_uptime_get();
+	uint64_t connected_ms = stream_connected_ms;
+	if (stream_conn) {
+		connected_ms += now - stream_connect_ms;
+	}
+	uint64_t advertising_ms = now - stream_enable_ms - connected_ms;
+	uint32_t interval_us = MAX(stream_interval, 6) * 1250;
+
+	return stream_air_us + connected_ms * 1000 / interval_us * STREAM_EVENT_US +
+	       advertising_ms / STREAM_ADV_INTERVAL_MS * STREAM_ADV_EVENT_US;
+}
+
+// Sends full notifications while the ring has data and credits are left. A partial one only
+// goes out once the ring is drained, and then waits a poll interval for more to pile up.
+static void stream_send(struct bt_conn *conn)
+{
+	uint16_t size = MIN(bt_gatt_get_mtu(conn) - 3, STREAM_PAYLOAD_MAX);
+
+	for (;;) {
+		stream_fill_payload(size);
+		if (stream_fill == 0) {
+			return;
+		}
+		if (atomic_get(&stream_inflight) >= STREAM_CREDITS) {
+			stream_stalls++;
+			return;
+		}
+
+		struct bt_gatt_notify_params params = {
+			.attr = &stream_svc.attrs[1],
+			.data = stream_payload,
+			.len = stream_fill,
+			.func = stream_sent,
+			.user_data = (void *)(uintptr_t)stream_generation,
+		};
+
+		atomic_inc(&stream_inflight);
+		int err = bt_gatt_notify_cb(conn, &params);
+		if (err) {
+			atomic_dec(&stream_inflight);
+			// Out of buffers is backpressure too; the payload is kept for the next try.
+			if (err == -ENOMEM || err == -ENOBUFS) {
+				stream_stalls++;
+			} else {
+				LOG_ERR("notify failed: %d", err);
+				stream_errors++;
+			}
+			return;
+		}
+
+		stream_bytes += stream_fill;
+		stream_notifications++;
+		stream_air_us += stream_notify_air_us(stream_fill);
+		bool full = stream_fill == size;
+		stream_fill = 0;
+		if (!full) {
+			return;
+		}
+	}
+}
+
+static void stream_thread_main(void *, void *, void *)
+{
+	for (;;) {
+		k_sem_take(&stream_wake, K_MSEC(STREAM_POLL_MS));
+		stream_wakeups++;
+
+		if (!atomic_test_bit(&stream_flags, STREAM_SUBSCRIBED)) {
+			continue;
+		}
+
+		k_spinlock_key_t key = k_spin_lock(&stream_lock);
+		struct bt_conn *conn = stream_conn ? bt_conn_ref(stream_conn) : NULL;
+		k_spin_unlock(&stream_lock, key);
+		if (conn == NULL) {
+			continue;
+		}
+
+		if (atomic_test_and_clear_bit(&stream_flags, STREAM_RESTART)) {
+			stream_restart();
+		}
+		stream_send(conn);
+		bt_conn_unref(conn);
+	}
+}
+
+void stream_init(void)
+{
+	int err = bt_enable(NULL);
+	if (err) {
+		LOG_ERR("bluetooth init failed: %d", err);
+		return;
+	}
+
+	stream_enable_ms = k_uptime_get();
+	k_work_submit(&stream_adv_work);
+
+	k_thread_create(&stream_thread, stream_thread_stack,
+			K_THREAD_STACK_SIZEOF(stream_thread_stack), stream_thread_main, NULL, NULL,
+			NULL, 9, 0, K_NO_WAIT);
+	k_thread_name_set(&stream_thread, "stream");
+
+	LOG_INF("advertising '%s'", CONFIG_BT_DEVICE_NAME);
+}
+
+static int cmd_stream_status(const struct shell *shell, size_t argc, char *argv[])
+{
+	uint32_t elapsed = k_uptime_get() - stream_start_ms;
+	uint16_t size = stream_mtu > 3 ? MIN(stream_mtu - 3, STREAM_PAYLOAD_MAX) : 0;
+	uint32_t notifications = stream_notifications;
+	uint32_t bytes = stream_bytes;
+	// Fill is how much of each notification's room was used; efficiency also counts the ATT and
+	// L2CAP headers every notification carries on air.
+	double fill = notifications && size ? 100.0 * bytes / ((double)notifications * size) : 0.0;
+	double efficiency =
+		bytes ? 100.0 * bytes / (bytes + (double)STREAM_HEADER_LEN * notifications) : 0.0;
+
+	shell_fprintf(shell, SHELL_NORMAL, "Stream status:\n");
+	shell_fprintf(shell, SHELL_NORMAL, " link: %s%s\n",
+		      stream_conn ? "connected" : "advertising",
+		      atomic_test_bit(&stream_flags, STREAM_SUBSCRIBED) ? ", subscribed" : "");
+	shell_fprintf(shell, SHELL_NORMAL,
+		      " negotiated: mtu=%u tx_phy=%u tx_len=%u interval=%u.%02u ms\n", stream_mtu,
+		      stream_tx_phy, stream_tx_len, stream_interval * 5 / 4,
+		      stream_interval * 125 % 100);
+	shell_fprintf(shell, SHELL_NORMAL, " data: bytes=%u (%u B/s) lost=%u packets\n", bytes,
+		      elapsed ? (uint32_t)((uint64_t)bytes * 1000 / elapsed) : 0,
+		      stream_reader.lost);
+	shell_fprintf(shell, SHELL_NORMAL,
+		      " notifications: %u (%u/s) fill=%.1f%% efficiency=%.1f%%\n", notifications,
+		      elapsed ? (uint32_t)((uint64_t)notifications * 1000 / elapsed) : 0, fill,
+		      efficiency);
+	shell_fprintf(shell, SHELL_NORMAL, " backpressure: stalls=%u errors=%u inflight=%d/%u\n",
+		      stream_stalls, stream_errors, (int)atomic_get(&stream_inflight),
+		      STREAM_CREDITS);
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(stream_cmds,
+			       SHELL_CMD_ARG(status, NULL, "print BLE stream status",
+					     cmd_stream_status, 1, 0),
+			       SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(stream, &stream_cmds, "BLE live stream", NULL);
@@ -0,0 +1,201 @@
+"""Benchmarks decoder.py on a synthetic session in the firmware's packet format.
+
+Packets are built the way the sensors write them with the default settings: 3 accel axes at
+100 Hz read 30 samples at a time, and pressure at 64 Hz and temperature at 8 Hz drained twice a
+second, all delta8 with the order1 predictor and an anchor every 10 s. The session is decoded
+from binary records and from `recorder dump` hex, and the first minute is checked sample for
+sample against packet.py, whose time for the whole session is extrapolated from it.
+
+Usage: python bench_decoder.py [--minutes 15] [--accel-rate 100]
+"""
+
+import argparse
+import math
+import random
+import struct
+import time
+
+import numpy as np
+
+import decoder
+import gen_rans_tables
+import packet
+
+ANCHOR_INTERVAL = 10000
+ACCEL_WATERMARK = 30
+DPS368_DRAIN_MS = 500
+PRESSURE_RATE = 64
+TEMPERATURE_RATE = 8
+QUANT = 1  # 0.1
+DUMP_LINE = 32
+
+
+def varint(value):
+    out = bytearray()
+    while value >= 0x80:
+        out.append(value & 0x7F | 0x80)
+        value >>= 7
+    out.append(value)
+    return bytes(out)
+
+
+def record(packet_type, payload):
+    header = len(payload) | 1 << 13 | packet_type << 14
+    out = struct.pack("<H", header) + payload
+    return out + b"\0" * (len(out) % packet.PACKET_ALIGN)
+
+
+def section(channel, samples, rate):
+    data = gen_rans_tables.delta8_pack(samples)
+    header = channel | QUANT << 3 | packet.CODEC_DELTA8 << 6 | len(data) << 8
+    header |= packet.PREDICTOR_ORDER1 << 19 | (rate is not None) << 21 | len(samples) << 22
+    return struct.pack("<I", header) + (struct.pack("<H", rate) if rate else b"") + data
+
+
+def quantize(value):
+    return max(-32768, min(32767, round(value * packet.QUANTIZE_FACTORS[QUANT])))
+
+
+def synthesize(minutes, accel_rate, seed=1):
+    """Returns the session's packet records, in the order the ring would hold them."""
+    rng = random.Random(seed)
+    end = minutes * 60000
+    accel_period = ACCEL_WATERMARK * 1000 / accel_rate
+    events = [(accel_period * (i + 1), 0) for i in range(int(end / accel_period))]
+    events += [(DPS368_DRAIN_MS * (i + 1), 1) for i in range(end // DPS368_DRAIN_MS)]
+    events.sort()
+
+    out = bytearray()
+    last = next_anchor = 0
+    config = set()
+    accel_n = pressure_n = temperature_n = 0
+    for ts, source in events:
+        ts = int(ts)
+        if ts >= next_anchor:
+            out += record(packet.PACKET_ANCHOR, bytes([packet.FORMAT_VERSION]) + varint(ts))
+            last = ts
+            next_anchor = ts + ANCHOR_INTERVAL
+            config.clear()
+
+        payload = bytearray(varint(ts - last))
+        last = ts
+        if source == 0:
+            for axis, channel in enumerate((1, 2, 3)):
+                samples = []
+                for i in range(accel_n, accel_n + ACCEL_WATERMARK):
+                    t = i / accel_rate
+                    mg = 1000 * (axis == 2) + 300 * math.sin(t * 2.1 + axis) + rng.gauss(0, 8)
+                    samples.append(quantize(mg))
+                rate = None if channel in config else accel_rate
+                config.add(channel)
+                payload += section(channel, samples, rate)
+            accel_n += ACCEL_WATERMARK
+        else:
+            n = PRESSURE_RATE * DPS368_DRAIN_MS // 1000
+            samples = [
+                quantize(101325 + 40 * math.sin(i / 3000) + rng.gauss(0, 2))
+                for i in range(pressure_n, pressure_n + n)
+            ]
+            pressure_n += n
+            payload += section(5, samples, None if 5 in config else PRESSURE_RATE)
+            n = TEMPERATURE_RATE * DPS368_DRAIN_MS // 1000
+            samples = [
+                quantize(25 + 5 * math.sin(i / 5000) + rng.gauss(0, 0.05))
+                for i in range(temperature_n, temperature_n + n)
+            ]
+            temperature_n += n
+            payload += section(4, samples, None if 4 in config else TEMPERATURE_RATE)
+            config.update((4, 5))
+        out += record(packet.PACKET_DATA, bytes(payload))
+    return bytes(out)
+
+
+def dump(data):
+    """Formats records the way `recorder dump` prints them."""
+    lines = (data[i : i + DUMP_LINE].hex().upper() for i in range(0, len(data), DUMP_LINE))
+    return "\n".join(lines) + "\n"
+
+
+def reference(data):
+    """Decodes with packet.py, returning {channel: samples} in packet order."""
+    samples = {}
+    for _, sections in packet.parse_packets(data):
+        for channel, quant, codec, pred, _, scale, payload in sections:
+            values = packet.decode_samples(payload, codec, channel, quant, pred, scale=scale)
+            samples.setdefault(channel, []).extend(values)
+    return samples
+
+
+def prefix(data, ms):
+    """Cuts the records at the first anchor at or after ms."""
+    pos = 0
+    while pos < len(data):
+        (header,) = struct.unpack_from("<H", data, pos)
+        if header >> 14 == packet.PACKET_ANCHOR:
+            ts, _ = packet.read_varint(data, pos + packet.PACKET_HEADER_SIZE + 1)
+            if ts >= ms:
+                return data[:pos]
+        pos += packet.PACKET_HEADER_SIZE + (header & 0x1FFF)
+        pos += -pos % packet.PACKET_ALIGN
+    return data
+
+
+def timed(fn):
+    start = time.perf_counter()
+    result = fn()
+    return result, time.perf_counter() - start
+
+
+def decode_chunks(data, chunk_size, hex_text=False):
+    d = decoder.Decoder()
+    for i in range(0, len(data), chunk_size):
+        if hex_text:
+            d.feed_hex(data[i : i + chunk_size])
+        else:
+            d.feed(data[i : i + chunk_size])
+    d.finish()
+    return d, d.channels()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--minutes", type=int, default=15)
+    parser.add_argument("--accel-rate", type=int, default=100)
+    args = parser.parse_args()
+
+    data, elapsed = timed(lambda: synthesize(args.minutes, args.accel_rate))
+    text = dump(data)
+    print(f"session: {args.minutes} min, {len(data)} bytes of records ({elapsed:.1f} s to build)")
+
+    (d, channels), binary_s = timed(lambda: decode_chunks(data, 65536))
+    print(
+        f"binary:    {binary_s:6.2f} s  {d.packets} packets  {d.samples} samples  "
+        f"{d.samples / binary_s / 1e6:.2f} Msamples/s  {len(data) / binary_s / 1e6:.1f} MB/s"
+    )
+    (h, hex_channels), hex_s = timed(lambda: decode_chunks(text, 65536, hex_text=True))
+    print(f"hex dump:  {hex_s:6.2f} s  {h.samples} samples  {len(text) / hex_s / 1e6:.1f} MB/s")
+    for name, (t, v) in channels.items():
+        if not np.array_equal(v, hex_channels[name][1]) or not np.array_equal(
+            t, hex_channels[name][0]
+        ):
+            raise SystemExit(f"{name}: hex and binary decodes differ")
+
+    axes = [channels[name] for name in ("accel.x", "accel.y", "accel.z")]
+    (times, _), merge_s = timed(lambda: decoder.merge(axes))
+    print(f"merge:     {merge_s:6.2f} s  {len(times)} accel rows")
+
+    head = prefix(data, 60000)
+    expected, reference_s = timed(lambda: reference(head))
+    d, got = decode_chunks(head, 65536)
+    for channel, samples in expected.items():
+        if not np.array_equal(got[packet.CHANNEL_NAMES[channel]][1], np.array(samples)):
+            raise SystemExit(f"{packet.CHANNEL_NAMES[channel]}: mismatch against packet.py")
+    total_s = reference_s * len(data) / len(head)
+    print(
+        f"packet.py: {reference_s:6.2f} s for the first minute, ~{total_s:.1f} s for the session "
+        f"({total_s / binary_s:.0f}x slower), first minute matches"
+    )
+
+
+if __name__ == "__main__":
+    main()
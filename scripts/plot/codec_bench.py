@@ -0,0 +1,165 @@
+"""Checks and tabulates the output of the firmware's `codec_bench dump`.
+
+The bench replays synthetic and recorded traces through the firmware encoder for every quantize
+setting and codec, on the board or on native_sim built with CONFIG_APP_CODEC_BENCH (debug.conf
+sets it), and prints each packet it wrote along with a CRC of the samples it fed in. This
+decodes every run's packets with packet.py, checks the samples come back bit for bit, and
+prints the firmware's bytes/sample, packets/s and ns/sample.
+It exits non-zero if any run doesn't round trip, so it can gate codec and ring changes:
+
+  (shell) codec_bench dump    # capture the shell output to a file
+  python codec_bench.py capture.txt
+
+With --write-trace it regenerates app/src/codec_bench_trace.h, the recorded trace the bench
+replays, from the accel.z packets of sample_log.txt.
+
+Usage: python codec_bench.py TRANSCRIPT | --write-trace
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+import gen_rans_tables
+import packet
+from rtt_reader import crc16_kermit
+
+TRACE_PATH = os.path.normpath(
+    os.path.join(os.path.dirname(packet.TABLES_PATH), "codec_bench_trace.h")
+)
+
+RUN_RE = re.compile(r"codec_bench: trace=(\S+) quant=(\S+) codec=(\S+)$")
+RESULT_RE = re.compile(
+    r"codec_bench: samples=(\d+) bytes/sample=([\d.]+) packets/s=(\d+) ns/sample=(\d+) "
+    r"clamped=(\d+) failures=(\d+) crc=([0-9a-f]{4})$"
+)
+
+
+def write_trace():
+    samples = [s for packets in gen_rans_tables.read_log()[(3, 1.0)] for s in packets]
+    lines = [
+        "// Generated by scripts/plot/codec_bench.py --write-trace - do not edit.",
+        "",
+        "#ifndef CODEC_BENCH_TRACE_H",
+        "#define CODEC_BENCH_TRACE_H",
+        "",
+        "// accel.z in mg from scripts/plot/sample_log.txt, 100 Hz.",
+        "static const int16_t codec_bench_recorded[] = {",
+    ]
+    for row in range(0, len(samples), 12):
+        lines.append("\t" + ", ".join(str(v) for v in samples[row : row + 12]) + ",")
+    lines += ["};", "", "#endif"]
+    with open(TRACE_PATH, "w") as f:
+        f.write("\n".join(lines) + "\n")
+    print(f"wrote {len(samples)} samples to {TRACE_PATH}")
+
+
+def parse_transcript(text):
+    """Splits a transcript into runs: (trace, quant, codec, records, result fields)."""
+    runs = []
+    run = None
+    for line in text.splitlines():
+        line = re.sub(r"^\d+> ", "", line.strip())
+        m = RUN_RE.search(line)
+        if m:
+            run = [*m.groups(), bytearray(), None]
+            runs.append(run)
+            continue
+        m = RESULT_RE.search(line)
+        if m and run is not None:
+            run[4] = m.groups()
+            run = None
+        elif run is not None:
+            run[3] += packet.parse_dump(line)
+    return runs
+
+
+def decode_run(records, tables):
+    """Returns the quantized integer samples of every data packet, in order."""
+    samples = []
+    rates = {}
+    scales = {}
+    pos = 0
+    while pos + packet.PACKET_HEADER_SIZE <= len(records):
+        (header,) = struct.unpack_from("<H", records, pos)
+        length, packet_type = header & 0x1FFF, header >> 14
+        payload = records[
+            pos + packet.PACKET_HEADER_SIZE : pos + packet.PACKET_HEADER_SIZE + length
+        ]
+        pos += packet.PACKET_HEADER_SIZE + length
+        pos += -pos % packet.PACKET_ALIGN
+        if packet_type != packet.PACKET_DATA:
+            continue
+        _, start = packet.read_varint(payload, 0)
+        for channel, quant, codec, pred, _, _, data in packet.parse_sections(
+            payload[start:], rates, scales
+        ):
+            if codec == packet.CODEC_RANS:
+                data = packet.rans_unpack(data, tables.model(channel, quant))
+            if codec == packet.CODEC_RICE:
+                samples += packet.decode_rice(data, pred)
+            else:
+                samples += packet.decode_delta8(data, pred)
+    return samples
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("transcript", nargs="?", help="shell output of `codec_bench dump`")
+    parser.add_argument("--write-trace", action="store_true", help="regenerate the recorded trace")
+    args = parser.parse_args()
+
+    if args.write_trace:
+        write_trace()
+        return
+    if args.transcript is None:
+        parser.error("a transcript is needed")
+
+    with open(args.transcript, errors="replace") as f:
+        runs = parse_transcript(f.read())
+    if not runs:
+        sys.exit("no codec_bench runs in the transcript")
+
+    tables = packet.RansTables()
+    failed = 0
+    print(
+        f"{'trace':>12} {'quant':>7} {'codec':>7} {'B/sample':>9} {'packets/s':>10} "
+        f"{'ns/sample':>10} {'clamped':>8}  round trip"
+    )
+    for trace, quant, codec, records, result in runs:
+        if result is None:
+            print(f"{trace:>12} {quant:>7} {codec:>7}  incomplete run")
+            failed += 1
+            continue
+        count, bytes_per_sample, packets_per_sec, ns, clamped, failures, crc = result
+
+        try:
+            samples = decode_run(bytes(records), tables)
+            got = crc16_kermit(struct.pack(f"<{len(samples)}h", *samples))
+            if len(samples) != int(count):
+                check = f"FAIL: {len(samples)} of {count} samples"
+            elif got != int(crc, 16):
+                check = f"FAIL: crc {got:04x}, expected {crc}"
+            else:
+                check = "ok"
+        except (ValueError, IndexError, struct.error) as e:
+            check = f"FAIL: {e}"
+        if not records:
+            check = "not dumped"
+        failed += check.startswith("FAIL")
+        if int(failures):
+            check += f" ({failures} packets not reserved)"
+
+        print(
+            f"{trace:>12} {quant:>7} {codec:>7} {float(bytes_per_sample):>9.2f} "
+            f"{int(packets_per_sec):>10} {int(ns):>10} {int(clamped):>8}  {check}"
+        )
+
+    print(f"{len(runs)} runs, {failed} failed")
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,277 @@
+"""Streaming decoder for channel packet records into per-channel NumPy arrays.
+
+packet.py is the bit-for-bit reference and walks everything in Python; this decodes the same
+records fast enough for whole sessions. Records are fed in chunks of any size, as binary (from
+rtt_reader.py --records) or as `recorder dump` hex text, and every channel comes out as a pair
+of float64 arrays, timestamps in seconds and values in the channel's units.
+
+delta8 sections with the order0 and order1 predictors, the firmware defaults, are decoded with
+NumPy, the samples between escapes being a cumulative sum of their deltas. rANS and Rice
+sections and the order2 and lpc predictors go through packet.py sample by sample.
+
+A sample's timestamp is its packet's timestamp, which is taken at the FIFO read and so belongs
+to the last sample of each section, less one sample period per sample after it.
+"""
+
+import struct
+
+import numpy as np
+
+import packet
+
+
+def escape_starts(tokens):
+    """Returns the positions of the delta8 escapes in tokens.
+
+    Every escape starts with 0xFF, but so may the two bytes of sample after it. Those are told
+    apart in Python, which is only needed where two 0xFF bytes are less than 3 bytes apart.
+    """
+    candidates = np.flatnonzero(tokens == 0xFF)
+    starts = np.ones(len(candidates), dtype=bool)
+    for i in np.flatnonzero(np.diff(candidates) <= 2) + 1:
+        for j in (i - 1, i - 2):
+            if j >= 0 and starts[j] and candidates[i] - candidates[j] <= 2:
+                starts[i] = False
+                break
+    return candidates[starts]
+
+
+def decode_delta8(tokens, first, order0):
+    """Decodes the concatenated delta8 payloads of many sections at once.
+
+    first marks the first byte of each section and order0 the bytes of sections using the order0
+    predictor, all others use order1. Returns the samples and, for each, whether it starts a
+    section.
+    """
+    escapes = escape_starts(tokens)
+    keep = np.ones(len(tokens), dtype=bool)
+    keep[escapes + 1] = False
+    keep[escapes + 2] = False
+
+    values = tokens.astype(np.int64) - 128
+    values[escapes] = (tokens[escapes + 1].astype(np.int64) << 8) + tokens[escapes + 2] - 32768
+
+    # A sample is the previous one plus its delta, except at resets: the start of a section,
+    # an escape, or any sample of an order0 section. Between resets that is a cumulative sum.
+    # Samples are clamped to 16 bits by the encoder, so the predictor's clamp never applies.
+    reset = first | order0
+    reset[escapes] = True
+    values, reset = values[keep], reset[keep]
+    deltas = np.where(reset, 0, values)
+    sums = np.cumsum(deltas)
+    resets = np.flatnonzero(reset)
+    run = np.cumsum(reset) - 1
+    samples = values[resets][run] + sums - sums[resets][run]
+    return samples, first[keep]
+
+
+class Decoder:
+    """Walks packet records as they arrive and collects samples per channel.
+
+    Timestamps are deltas from the previous packet, so like packet.parse_packets() decoding
+    starts at the first anchor. Gap records are kept in gaps as (channel, start, end, samples)
+    with timestamps in milliseconds.
+
+    Packet and section headers are walked in Python. The sections of each fed chunk that can be
+    decoded with NumPy are collected and decoded in one go, so the per-section cost stays small.
+    """
+
+    def __init__(self, tables=None):
+        self.tables = tables
+        self.pending = b""
+        self.hex_pending = ""
+        self.timestamp = None
+        self.rates = {}
+        self.scales = {}
+        self.times = {}
+        self.values = {}
+        self.gaps = []
+        self.packets = 0
+        self.samples = 0
+        self.skipped = 0
+
+    def feed(self, data):
+        """Decodes every complete record in data, keeping a trailing partial one for later."""
+        buf = self.pending + bytes(data) if self.pending else bytes(data)
+        batch = []
+        pos = 0
+        end = len(buf)
+        while pos + packet.PACKET_HEADER_SIZE <= end:
+            (header,) = struct.unpack_from("<H", buf, pos)
+            length, packet_type = header & 0x1FFF, header >> 14
+            start = pos + packet.PACKET_HEADER_SIZE
+            next_pos = start + length + (-(start + length) % packet.PACKET_ALIGN)
+            if next_pos > end:
+                break
+            pos = next_pos
+
+            if packet_type == packet.PACKET_DATA:
+                self.data_packet(buf, start, start + length, batch)
+            elif packet_type == packet.PACKET_ANCHOR:
+                if buf[start] != packet.FORMAT_VERSION:
+                    raise ValueError(f"unsupported packet format version {buf[start]}")
+                self.timestamp, _ = packet.read_varint(buf, start + 1)
+            elif packet_type == packet.PACKET_GAP:
+                self.gaps.extend(packet.parse_gap(buf[start : start + length]))
+        self.pending = buf[pos:]
+        self.decode_batch(buf, batch)
+
+    def feed_hex(self, text):
+        """Like feed(), for the hex lines printed by `recorder dump`."""
+        text = self.hex_pending + text
+        complete = text.rfind("\n") + 1
+        self.hex_pending = text[complete:]
+        self.feed(packet.parse_dump(text[:complete]))
+
+    def finish(self):
+        """Decodes whatever is left of a hex line that had no newline."""
+        if self.hex_pending:
+            self.feed(packet.parse_dump(self.hex_pending))
+            self.hex_pending = ""
+
+    def data_packet(self, buf, pos, end, batch):
+        if self.timestamp is None:
+            self.skipped += 1
+            return
+        delta, pos = packet.read_varint(buf, pos)
+        self.timestamp += delta
+        self.packets += 1
+        while pos < end:
+            (header,) = struct.unpack_from("<I", buf, pos)
+            pos += packet.SECTION_HEADER_SIZE
+            channel, quant, codec = header & 0x7, (header >> 3) & 0x7, (header >> 6) & 0x3
+            length, pred = (header >> 8) & 0x7FF, (header >> 19) & 0x3
+            if (header >> 21) & 0x1:
+                (self.rates[channel],) = struct.unpack_from("<H", buf, pos)
+                pos += packet.SECTION_RATE_SIZE
+                if quant == packet.QUANTIZE_RAW:
+                    (self.scales[channel],) = struct.unpack_from("<f", buf, pos)
+                    pos += packet.SECTION_SCALE_SIZE
+
+            rate = self.rates.get(channel)
+            if not rate or length == 0:
+                self.skipped += not rate
+            elif codec == packet.CODEC_DELTA8 and pred <= packet.PREDICTOR_ORDER1:
+                # Exactly what packet.decode_samples() computes: codes times the scale, or
+                # quantized samples divided by the factor.
+                if quant == packet.QUANTIZE_RAW:
+                    scale, factor = float(self.scales[channel]), 1.0
+                else:
+                    scale, factor = 1.0, packet.QUANTIZE_FACTORS[quant]
+                batch.append((pos, length, channel, pred, self.timestamp, rate, scale, factor))
+            else:
+                # Flushing the batch first keeps every channel's samples in ring order.
+                self.decode_batch(buf, batch)
+                self.section(channel, quant, codec, pred, buf[pos : pos + length])
+            pos += length
+
+    def decode_batch(self, buf, batch):
+        if not batch:
+            return
+        columns = (np.array(c) for c in zip(*batch))
+        offset, length, channel, pred, timestamp, rate, scale, factor = columns
+
+        # Gather every section's payload into one array, remembering which section each byte
+        # came from.
+        section = np.repeat(np.arange(len(batch)), length)
+        starts = np.cumsum(length) - length
+        index = offset[section] + np.arange(len(section)) - starts[section]
+        tokens = np.frombuffer(buf, dtype=np.uint8)[index]
+        first = np.zeros(len(tokens), dtype=bool)
+        first[starts] = True
+        order0 = (pred == packet.PREDICTOR_ORDER0)[section]
+
+        samples, first = decode_delta8(tokens, first, order0)
+        section = np.cumsum(first) - 1
+        counts = np.bincount(section, minlength=len(batch))
+        after = np.cumsum(counts)[section] - 1 - np.arange(len(samples))
+
+        times = timestamp[section] / 1000.0 - after / rate[section]
+        values = samples * scale[section] / factor[section]
+        sample_channel = channel[section]
+        for ch in np.unique(channel):
+            mask = sample_channel == ch
+            self.times.setdefault(int(ch), []).append(times[mask])
+            self.values.setdefault(int(ch), []).append(values[mask])
+        self.samples += len(samples)
+        batch.clear()
+
+    def section(self, channel, quant, codec, pred, data):
+        """Decodes a section NumPy can't, with packet.py."""
+        if codec == packet.CODEC_RANS and self.tables is None:
+            self.tables = packet.RansTables()
+        scale = self.scales.get(channel)
+        values = packet.decode_samples(data, codec, channel, quant, pred, self.tables, scale)
+        rate = self.rates[channel]
+        n = len(values)
+        self.times.setdefault(channel, []).append(
+            self.timestamp / 1000.0 - np.arange(n - 1, -1, -1) / rate
+        )
+        self.values.setdefault(channel, []).append(np.array(values, dtype=np.float64))
+        self.samples += n
+
+    def channel(self, channel):
+        """Returns (timestamps, values) of a channel, by number or name, in ring order.
+
+        Each FIFO read is timestamped when it was read, so the first samples of a packet can
+        reach back a little before the last ones of the packet before it.
+        """
+        if isinstance(channel, str):
+            channel = packet.CHANNEL_NAMES.index(channel)
+        if channel not in self.times:
+            return np.empty(0), np.empty(0)
+        times = np.concatenate(self.times[channel])
+        values = np.concatenate(self.values[channel])
+        self.times[channel] = [times]
+        self.values[channel] = [values]
+        return times, values
+
+    def channels(self):
+        """Returns {name: (timestamps, values)} for every channel seen."""
+        return {packet.CHANNEL_NAMES[ch]: self.channel(ch) for ch in sorted(self.times)}
+
+
+def merge(series):
+    """Aligns several (timestamps, values) series on the union of their timestamps.
+
+    Returns (timestamps, columns), where each column holds its series' latest value at or before
+    each timestamp, NaN before its first one. Series are almost sorted already, only packets
+    overlapping a little in time are out of order, so sorting them and their union is a merge of
+    sorted runs rather than a full sort.
+    """
+    series = [(t[order], v[order]) for t, v in series for order in [np.argsort(t, kind="stable")]]
+    times = np.sort(np.concatenate([t for t, _ in series]), kind="stable")
+    if len(times):
+        times = times[np.concatenate(([True], np.diff(times) > 0))]
+    columns = []
+    for t, v in series:
+        index = np.searchsorted(t, times, side="right") - 1
+        column = v[np.maximum(index, 0)] if len(v) else np.full(len(times), np.nan)
+        column[index < 0] = np.nan
+        columns.append(column)
+    return times, columns
+
+
+def is_hex(head):
+    """Guesses from the start of a capture whether it is `recorder dump` text."""
+    try:
+        text = head.decode("ascii")
+    except UnicodeDecodeError:
+        return False
+    return any(len(packet.parse_dump(line)) for line in text.splitlines()[:-1])
+
+
+def decode_file(path, chunk_size=1 << 20, decoder=None):
+    """Stream-decodes a binary or hex capture file, returning the Decoder."""
+    decoder = decoder or Decoder()
+    with open(path, "rb") as f:
+        data = f.read(chunk_size)
+        hex_text = is_hex(data)
+        while data:
+            if hex_text:
+                decoder.feed_hex(data.decode("ascii"))
+            else:
+                decoder.feed(data)
+            data = f.read(chunk_size)
+    decoder.finish()
+    return decoder
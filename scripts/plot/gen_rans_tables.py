@@ -0,0 +1,244 @@
+"""Generates app/src/rans_tables.h, the static rANS models compiled into the firmware.
+
+Order-1 (delta) residuals are modelled per channel and quantize level. Where sample_log.txt was
+captured at the same resolution as a firmware quantize level, the model is the logged token
+histogram; everywhere else it is a two-sided geometric fitted to the logged mean |delta| and
+scaled to the quantize factor. Geometric models with similar spread are shared between channels
+to keep the flash footprint small.
+
+After writing the header the script round-trips the sample log through a port of the firmware
+encoder and the host decoder in packet.py, and reports bytes/sample for each codec.
+
+Usage: python gen_rans_tables.py
+"""
+
+import math
+import os
+from collections import defaultdict
+
+import packet
+
+HERE = os.path.dirname(__file__)
+
+# Sample log channel name -> (firmware channel, log step in firmware units). Accel is logged in
+# mg, pressure in hPa (firmware: Pa) and temperature in degC.
+LOG_CHANNELS = {
+    "lis3dhtr.accel.x": (1, 1.0),
+    "lis3dhtr.accel.y": (2, 1.0),
+    "lis3dhtr.accel.z": (3, 1.0),
+    "dps368.temp": (4, 0.001),
+    "dps368.hpa": (5, 1.0),
+}
+
+# Raw sections carry sensor codes rather than a quantize level; this is codes per firmware unit.
+# LIS3DH codes are 1 mg at +-2 g in high resolution, and the other channels have no raw producer.
+RAW_FACTOR = 1.0
+
+# The null channel carries the `channel start_test` ramp, which steps by one each sample.
+NULL_CHANNEL_MEAN = 1.0
+
+MIN_MEAN = 0.05
+MAX_MEAN = 256.0
+EMPIRICAL_WEIGHT = 0.9
+
+
+def read_log():
+    """Returns {(channel, step): [[sample, ...], ...]} for sample_log.txt."""
+    with open(os.path.join(HERE, "sample_log.txt")) as f:
+        log = f.read()
+    packets = defaultdict(list)
+    for line in log.lower().splitlines():
+        if "packet:" not in line:
+            continue
+        name, _, _, _, hex_data = line.split("packet:")[1].strip().split(" ", 4)
+        packets[LOG_CHANNELS[name]].append(packet.decode_delta8(bytes.fromhex(hex_data)))
+    return packets
+
+
+def delta8_pack(samples):
+    """Port of the delta8 writer in channel_add_packet_sample()."""
+    out = bytearray()
+    last = 0
+    for s in samples:
+        d = s - last
+        if d >= 127 or d < -128:
+            u = s + 32768
+            out.extend([0xFF, (u >> 8) & 0xFF, u & 0xFF])
+        else:
+            out.append(d + 128)
+        last = s
+    return bytes(out)
+
+
+def delta8_symbols(tokens):
+    """Yields the modelled symbol of each delta8 token, skipping escape payload bytes."""
+    i = 0
+    while i < len(tokens):
+        yield tokens[i]
+        i += 3 if tokens[i] == packet.RANS_ESCAPE else 1
+
+
+def mean_abs_delta(packets):
+    deltas = [b - a for samples in packets for a, b in zip(samples, samples[1:])]
+    return sum(abs(d) for d in deltas) / len(deltas)
+
+
+def geometric_probs(mean):
+    """Two-sided geometric p(d) ~ t^|d| with the given mean |d|, indexed by delta8 token."""
+    mean = min(max(mean, MIN_MEAN), MAX_MEAN)
+    # E|d| = 2t / (1 - t^2); solve for t.
+    t = (math.sqrt(1 + mean * mean) - 1) / mean
+    p = [t ** abs(s - 128) for s in range(255)]
+    # Mass outside [-128, 126] becomes the escape symbol.
+    p.append((t**127 + t**129) / (1 - t))
+    total = sum(p)
+    return [v / total for v in p]
+
+
+def empirical_probs(packets, mean):
+    """Token histogram of the logged packets, blended with the geometric fit for unseen deltas."""
+    counts = [0] * 256
+    for samples in packets:
+        for s in delta8_symbols(delta8_pack(samples)):
+            counts[s] += 1
+    total = sum(counts)
+    return [
+        EMPIRICAL_WEIGHT * c / total + (1 - EMPIRICAL_WEIGHT) * g
+        for c, g in zip(counts, geometric_probs(mean))
+    ]
+
+
+def normalize(p):
+    """Quantizes probabilities to a 4096-slot table where every token stays encodable."""
+    m = 1 << packet.RANS_SCALE_BITS
+    freq = [max(1, int(v * m)) for v in p]
+    # Hand out the rounding remainder to (or take it from) the most probable symbols.
+    order = sorted(range(256), key=lambda s: -p[s])
+    i = 0
+    while sum(freq) != m:
+        s = order[i % 256]
+        if sum(freq) < m:
+            freq[s] += 1
+        elif freq[s] > 1:
+            freq[s] -= 1
+        i += 1
+    return freq
+
+
+def rans_pack(tokens, model):
+    """Port of rans_encode() in app/src/rans.c."""
+    uniform = packet.RansModel([1 << (packet.RANS_SCALE_BITS - 8)] * 256)
+
+    symbols = []
+    i = 0
+    while i < len(tokens):
+        symbols.append((model, tokens[i]))
+        if tokens[i] == packet.RANS_ESCAPE:
+            symbols.append((uniform, tokens[i + 1]))
+            symbols.append((uniform, tokens[i + 2]))
+            i += 3
+        else:
+            i += 1
+
+    x = packet.RANS_BYTE_L
+    out = bytearray()
+    for m, s in reversed(symbols):
+        freq = m.freq[s]
+        x_max = ((packet.RANS_BYTE_L >> packet.RANS_SCALE_BITS) << 8) * freq
+        while x >= x_max:
+            out.append(x & 0xFF)
+            x >>= 8
+        x = ((x // freq) << packet.RANS_SCALE_BITS) + (x % freq) + m.start[s]
+    out.extend([(x >> 24) & 0xFF, (x >> 16) & 0xFF, (x >> 8) & 0xFF, x & 0xFF])
+    return bytes(reversed(out))
+
+
+def build_models(log_packets):
+    base_mean = [NULL_CHANNEL_MEAN] + [0.0] * (len(packet.CHANNEL_NAMES) - 1)
+    for (ch, step), packets in log_packets.items():
+        base_mean[ch] = mean_abs_delta(packets) * step
+
+    models = []
+    shared = {}
+    model_index = []
+    for ch, mean in enumerate(base_mean):
+        row = []
+        for factor in packet.QUANTIZE_FACTORS + [RAW_FACTOR]:
+            step = 1.0 / factor
+            if (ch, step) in log_packets:
+                if (ch, step) not in shared:
+                    shared[(ch, step)] = len(models)
+                    probs = empirical_probs(log_packets[(ch, step)], mean * factor)
+                    models.append(normalize(probs))
+                row.append(shared[(ch, step)])
+                continue
+            key = round(2 * math.log2(min(max(mean * factor, MIN_MEAN), MAX_MEAN)))
+            if key not in shared:
+                shared[key] = len(models)
+                models.append(normalize(geometric_probs(2 ** (key / 2))))
+            row.append(shared[key])
+        model_index.append(row)
+    return models, model_index
+
+
+def write_header(models, model_index):
+    lines = [
+        "// Generated by scripts/plot/gen_rans_tables.py - do not edit.",
+        "",
+        "#ifndef RANS_TABLES_H",
+        "#define RANS_TABLES_H",
+        "",
+        f"#define RANS_MODEL_COUNT {len(models)}",
+        "",
+    ]
+    starts = [packet.RansModel(freq).start for freq in models]
+    for name, tables in (("freq", models), ("start", starts)):
+        lines.append(f"static const uint16_t rans_model_{name}[RANS_MODEL_COUNT][256] = {{")
+        for values in tables:
+            lines.append("\t{")
+            for row in range(0, 256, 16):
+                lines.append("\t\t" + ", ".join(str(v) for v in values[row : row + 16]) + ",")
+            lines.append("\t},")
+        lines.append("};")
+        lines.append("")
+    lines.append("static const uint8_t rans_model_index[CHANNEL_COUNT][QUANTIZE_COUNT] = {")
+    for ch, row in enumerate(model_index):
+        lines.append(f"\t{{{', '.join(str(v) for v in row)}}}, // {packet.CHANNEL_NAMES[ch]}")
+    lines.append("};")
+    lines.append("")
+    lines.append("#endif")
+    with open(packet.TABLES_PATH, "w") as f:
+        f.write("\n".join(lines) + "\n")
+
+
+def main():
+    log_packets = read_log()
+    models, model_index = build_models(log_packets)
+    write_header(models, model_index)
+    print(f"wrote {len(models)} models to {os.path.normpath(packet.TABLES_PATH)}")
+
+    # Round-trip the log through the tables as the firmware would see them. Temperature is
+    # logged finer than any quantize level, so it is checked at the closest one.
+    tables = packet.RansTables()
+    for (ch, step), packets in sorted(log_packets.items()):
+        factors = packet.QUANTIZE_FACTORS
+        quant = min(range(len(factors)), key=lambda q: abs(math.log10(factors[q] * step)))
+        model = tables.model(ch, quant)
+        count = delta8_bytes = rans_bytes = 0
+        for samples in packets:
+            tokens = delta8_pack(samples)
+            encoded = rans_pack(tokens, model)
+            if packet.rans_unpack(encoded, model) != tokens:
+                raise SystemExit(f"round-trip failed on {packet.CHANNEL_NAMES[ch]}")
+            count += len(samples)
+            delta8_bytes += len(tokens)
+            # The firmware falls back to delta8 when rANS does not save anything.
+            rans_bytes += min(len(encoded), len(tokens))
+        print(
+            f"{packet.CHANNEL_NAMES[ch]:>12} @ {packet.QUANTIZE_NAMES[quant]}: samples={count} "
+            f"delta8={delta8_bytes / count:.2f} B/sample rans={rans_bytes / count:.2f} B/sample"
+        )
+
+
+if __name__ == "__main__":
+    main()
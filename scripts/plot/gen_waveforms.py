@@ -0,0 +1,85 @@
+"""Builds the native_sim sensor emulators' waveforms from the CSV files in waveforms/.
+
+Each file is one replayable scenario: keyframes of acceleration (mg), vibration amplitude (mg)
+and frequency (Hz), pressure (Pa) and temperature (degC), which the emulators interpolate
+linearly and loop. See app/src/emul.c for how vibration and noise are added on top. The first
+comment lines of a file describe it. The firmware starts on the first waveform by name and
+`emul wave NAME` switches.
+
+Usage: python gen_waveforms.py   # writes app/src/emul_waveforms.h
+"""
+
+import csv
+import glob
+import os
+
+import packet
+
+WAVEFORM_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "waveforms")
+HEADER_PATH = os.path.normpath(
+    os.path.join(os.path.dirname(packet.TABLES_PATH), "emul_waveforms.h")
+)
+COLUMNS = ["t_ms", "x_mg", "y_mg", "z_mg", "vib_mg", "vib_hz", "pressure_pa", "temp_c"]
+
+
+def read_waveform(path):
+    """Returns (description, keyframes) with every keyframe as the integers the C table holds."""
+    description = []
+    rows = []
+    with open(path, newline="") as f:
+        lines = [line for line in f if line.strip()]
+    for line in lines:
+        if not line.startswith("#"):
+            break
+        description.append(line[1:].strip())
+    reader = csv.DictReader(line for line in lines if not line.startswith("#"))
+    if reader.fieldnames != COLUMNS:
+        raise ValueError(f"{path}: columns must be {','.join(COLUMNS)}")
+    for row in reader:
+        values = [int(row[c]) for c in COLUMNS[:-1]] + [round(float(row["temp_c"]) * 100)]
+        if rows and values[0] <= rows[-1][0]:
+            raise ValueError(f"{path}: t_ms must increase, at {values[0]}")
+        if not all(-32768 <= v <= 32767 for v in values[1:6]):
+            raise ValueError(f"{path}: acceleration or vibration out of range at {values[0]}")
+        rows.append(values)
+    if len(rows) < 2 or rows[0][0] != 0:
+        raise ValueError(f"{path}: needs at least two keyframes, the first at t_ms 0")
+    return description, rows
+
+
+def main():
+    paths = sorted(glob.glob(os.path.join(WAVEFORM_DIR, "*.csv")))
+    waveforms = []
+    for path in paths:
+        name = os.path.splitext(os.path.basename(path))[0]
+        waveforms.append((name, *read_waveform(path)))
+
+    lines = [
+        "// Generated by scripts/plot/gen_waveforms.py from scripts/plot/waveforms/ - do not edit.",
+        "",
+        "#ifndef EMUL_WAVEFORMS_H",
+        "#define EMUL_WAVEFORMS_H",
+    ]
+    for name, description, rows in waveforms:
+        lines.append("")
+        lines += [f"// {line}" for line in description or [name]]
+        lines.append(f"static const struct emul_keyframe emul_{name}[] = {{")
+        for t, x, y, z, vib_mg, vib_hz, pressure, temp in rows:
+            lines.append(f"\t{{{t}, {{{x}, {y}, {z}}}, {vib_mg}, {vib_hz}, {pressure}, {temp}}},")
+        lines.append("};")
+
+    lines += ["", "static const struct emul_waveform emul_waveforms[] = {"]
+    lines += [f'\t{{"{name}", emul_{name}, ARRAY_SIZE(emul_{name})}},' for name, _, _ in waveforms]
+    lines += ["};", "", "static const char *emul_waveform_names[] = {"]
+    lines += [f'\t"{name}",' for name, _, _ in waveforms]
+    lines += ["};", ""]
+    lines.append(f'#define EMUL_WAVEFORM_HELP "{"|".join(name for name, _, _ in waveforms)}"')
+    lines += ["", "#endif"]
+
+    with open(HEADER_PATH, "w") as f:
+        f.write("\n".join(lines) + "\n")
+    print(f"wrote {len(waveforms)} waveforms to {HEADER_PATH}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,308 @@
+"""Host-side decoder for kartcam_tire channel packets.
+
+Mirrors the encoders in app/src/channel.c and app/src/rans.c bit for bit. The rANS frequency
+tables are read straight from app/src/rans_tables.h so the host can never drift from what the
+firmware was built with.
+"""
+
+import os
+import re
+import struct
+
+CHANNEL_NAMES = ["null", "accel.x", "accel.y", "accel.z", "temperature", "pressure"]
+QUANTIZE_NAMES = ["1.0", "0.1", "0.01", "0.001", "0.0001", "raw"]
+QUANTIZE_FACTORS = [1.0, 0.1, 0.01, 0.001, 0.0001]
+QUANTIZE_RAW = 5
+CODEC_NAMES = ["delta8", "rans", "rice"]
+
+CODEC_DELTA8 = 0
+CODEC_RANS = 1
+CODEC_RICE = 2
+
+PREDICTOR_NAMES = ["order0", "order1", "order2", "lpc"]
+
+PREDICTOR_ORDER0 = 0
+PREDICTOR_ORDER1 = 1
+PREDICTOR_ORDER2 = 2
+PREDICTOR_LPC = 3
+
+FORMAT_VERSION = 4
+
+PACKET_DATA = 0
+PACKET_PADDING = 1
+PACKET_ANCHOR = 2
+PACKET_GAP = 3
+
+PACKET_HEADER_SIZE = 2
+PACKET_ALIGN = 2
+SECTION_HEADER_SIZE = 4
+SECTION_RATE_SIZE = 2
+SECTION_SCALE_SIZE = 4
+
+RANS_SCALE_BITS = 12
+RANS_BYTE_L = 1 << 23
+RANS_ESCAPE = 0xFF
+
+RICE_LIMIT = 15
+RICE_ESCAPE_BITS = 17
+RICE_MEAN_SHIFT = 4
+RICE_INITIAL_MEAN = 4
+
+TABLES_PATH = os.path.join(os.path.dirname(__file__), "..", "..", "app", "src", "rans_tables.h")
+
+
+def _parse_array(text, name):
+    m = re.search(name + r"\[[^=]*=\s*\{(.*?)\};", text, re.S)
+    if m is None:
+        raise ValueError(f"{name} not found in rans tables")
+    rows = re.findall(r"\{([^{}]*)\}", m.group(1))
+    return [[int(v, 0) for v in row.replace("\n", " ").split(",") if v.strip()] for row in rows]
+
+
+class RansModel:
+    def __init__(self, freq):
+        assert len(freq) == 256 and sum(freq) == 1 << RANS_SCALE_BITS
+        self.freq = freq
+        self.start = [0] * 256
+        for s in range(1, 256):
+            self.start[s] = self.start[s - 1] + freq[s - 1]
+        self.slot_to_symbol = []
+        for s, f in enumerate(freq):
+            self.slot_to_symbol.extend([s] * f)
+
+
+class RansTables:
+    def __init__(self, path=TABLES_PATH):
+        with open(path) as f:
+            text = f.read()
+        self.models = [RansModel(freq) for freq in _parse_array(text, "rans_model_freq")]
+        self.model_index = _parse_array(text, "rans_model_index")
+
+    def model(self, channel, quant):
+        return self.models[self.model_index[channel][quant]]
+
+
+def predict(samples, pred):
+    """Port of predict() in app/src/channel.c."""
+    n = len(samples)
+    if n == 0 or pred == PREDICTOR_ORDER0:
+        p = 0
+    elif n == 1 or pred == PREDICTOR_ORDER1:
+        p = samples[-1]
+    elif pred == PREDICTOR_ORDER2:
+        p = 2 * samples[-1] - samples[-2]
+    else:
+        p = (3 * samples[-1] - samples[-2]) >> 1
+    return min(max(p, -32768), 32767)
+
+
+def decode_delta8(data, pred=PREDICTOR_ORDER1):
+    """Decodes a delta8 payload into quantized integer samples."""
+    samples = []
+    i = 0
+    while i < len(data):
+        if data[i] == 0xFF:
+            samples.append(((data[i + 1] << 8) | data[i + 2]) - 32768)
+            i += 3
+        else:
+            samples.append(predict(samples, pred) + data[i] - 128)
+            i += 1
+    return samples
+
+
+class BitReader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def remaining(self):
+        return len(self.data) * 8 - self.pos
+
+    def bit(self):
+        b = (self.data[self.pos >> 3] >> (7 - (self.pos & 7))) & 1
+        self.pos += 1
+        return b
+
+    def bits(self, n):
+        v = 0
+        for _ in range(n):
+            v = (v << 1) | self.bit()
+        return v
+
+
+def decode_rice(data, pred=PREDICTOR_ORDER1):
+    """Decodes an adaptive Rice payload into quantized integer samples."""
+    r = BitReader(data)
+    if r.remaining() < 16:
+        return []
+    samples = [r.bits(16) - 32768]
+    rice_sum = RICE_INITIAL_MEAN << RICE_MEAN_SHIFT
+    while True:
+        q = 0
+        while q < RICE_LIMIT:
+            if r.remaining() == 0:
+                # Running out inside a unary prefix means we just read the ones padding.
+                return samples
+            if r.bit() == 0:
+                break
+            q += 1
+        mean = rice_sum >> RICE_MEAN_SHIFT
+        k = mean.bit_length() - 1 if mean else 0
+        if q < RICE_LIMIT:
+            u = (q << k) | r.bits(k)
+        else:
+            u = r.bits(RICE_ESCAPE_BITS)
+        d = (u >> 1) ^ -(u & 1)
+        samples.append(predict(samples, pred) + d)
+        rice_sum += u - (rice_sum >> RICE_MEAN_SHIFT)
+
+
+def rans_unpack(data, model):
+    """Decodes a rANS payload back into the delta8 token stream it was built from."""
+    if len(data) < 4:
+        raise ValueError("rans payload too short")
+    mask = (1 << RANS_SCALE_BITS) - 1
+    uniform = model.__class__([1 << (RANS_SCALE_BITS - 8)] * 256)
+
+    x = data[0] | data[1] << 8 | data[2] << 16 | data[3] << 24
+    pos = 4
+
+    def get(m):
+        nonlocal x, pos
+        s = m.slot_to_symbol[x & mask]
+        x = m.freq[s] * (x >> RANS_SCALE_BITS) + (x & mask) - m.start[s]
+        while x < RANS_BYTE_L:
+            if pos >= len(data):
+                raise ValueError("rans payload truncated")
+            x = (x << 8) | data[pos]
+            pos += 1
+        return s
+
+    out = bytearray()
+    while not (pos == len(data) and x == RANS_BYTE_L):
+        s = get(model)
+        out.append(s)
+        if s == RANS_ESCAPE:
+            out.append(get(uniform))
+            out.append(get(uniform))
+    return bytes(out)
+
+
+def read_varint(data, pos):
+    """Reads a LEB128 varint, returning (value, next position)."""
+    value = 0
+    shift = 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if byte < 0x80:
+            return value, pos
+
+
+def parse_sections(payload, rates, scales):
+    """Splits the sections of a data packet into (channel, quant, codec, pred, rate, scale, data).
+
+    Sections only carry a rate (and, for raw sections, a scale) when it changes, so rates and
+    scales map channel to the last value seen and are updated as sections carrying one go by.
+    """
+    sections = []
+    pos = 0
+    while pos < len(payload):
+        (header,) = struct.unpack_from("<I", payload, pos)
+        pos += SECTION_HEADER_SIZE
+        channel, quant, codec = header & 0x7, (header >> 3) & 0x7, (header >> 6) & 0x3
+        length, pred = (header >> 8) & 0x7FF, (header >> 19) & 0x3
+        has_config = (header >> 21) & 0x1
+        if has_config:
+            (rates[channel],) = struct.unpack_from("<H", payload, pos)
+            pos += SECTION_RATE_SIZE
+            if quant == QUANTIZE_RAW:
+                (scales[channel],) = struct.unpack_from("<f", payload, pos)
+                pos += SECTION_SCALE_SIZE
+        data = payload[pos : pos + length]
+        scale = scales.get(channel) if quant == QUANTIZE_RAW else None
+        sections.append((channel, quant, codec, pred, rates.get(channel), scale, data))
+        pos += length
+    return sections
+
+
+def parse_gap(payload):
+    """Splits a gap record into (channel, start, end, samples) per channel.
+
+    Readers hand one out ahead of the anchor they pick up again at after losing packets to ring
+    eviction: start and end are the timestamps of the first and last lost packet of the channel.
+    """
+    gaps = []
+    pos = 0
+    while pos < len(payload):
+        channel = payload[pos]
+        start, pos = read_varint(payload, pos + 1)
+        end, pos = read_varint(payload, pos)
+        samples, pos = read_varint(payload, pos)
+        gaps.append((channel, start, end, samples))
+    return gaps
+
+
+def parse_packets(data, gaps=None):
+    """Walks packet records in ring order and yields (timestamp, sections) per data packet.
+
+    Timestamps are deltas from the previous packet, so decoding starts at the first anchor and
+    anything before it is skipped. Gap records are appended to gaps, if given, as parse_gap()
+    tuples.
+    """
+    pos = 0
+    timestamp = None
+    rates = {}
+    scales = {}
+    while pos + PACKET_HEADER_SIZE <= len(data):
+        (header,) = struct.unpack_from("<H", data, pos)
+        length, packet_type = header & 0x1FFF, header >> 14
+        payload = data[pos + PACKET_HEADER_SIZE : pos + PACKET_HEADER_SIZE + length]
+        pos += PACKET_HEADER_SIZE + length
+        pos += -pos % PACKET_ALIGN
+        if packet_type == PACKET_ANCHOR:
+            if payload[0] != FORMAT_VERSION:
+                raise ValueError(f"unsupported packet format version {payload[0]}")
+            timestamp, _ = read_varint(payload, 1)
+        elif packet_type == PACKET_DATA and timestamp is not None:
+            delta, start = read_varint(payload, 0)
+            timestamp += delta
+            yield timestamp, parse_sections(payload[start:], rates, scales)
+        elif packet_type == PACKET_GAP and gaps is not None:
+            gaps.extend(parse_gap(payload))
+
+
+def parse_dump(text):
+    """Collects the hex lines printed by `recorder dump` back into packet record bytes.
+
+    Lines may carry an RTT terminal prefix such as "00> "; anything else is ignored.
+    """
+    data = bytearray()
+    for line in text.splitlines():
+        line = re.sub(r"^\d+> ", "", line.strip())
+        if line and len(line) % 2 == 0 and re.fullmatch(r"[0-9A-Fa-f]+", line):
+            data += bytes.fromhex(line)
+    return bytes(data)
+
+
+def decode_samples(data, codec, channel, quant, pred, tables=None, scale=None):
+    """Decodes a packet payload into sample values in the channel's native units.
+
+    Raw sections hold sensor codes, which are converted with the scale parsed from the section.
+    """
+    if codec == CODEC_RANS:
+        if tables is None:
+            tables = RansTables()
+        samples = decode_delta8(rans_unpack(data, tables.model(channel, quant)), pred)
+    elif codec == CODEC_RICE:
+        samples = decode_rice(data, pred)
+    elif codec == CODEC_DELTA8:
+        samples = decode_delta8(data, pred)
+    else:
+        raise ValueError(f"unknown codec {codec}")
+    if quant == QUANTIZE_RAW:
+        return [s * scale for s in samples]
+    factor = QUANTIZE_FACTORS[quant]
+    return [s / factor for s in samples]
@@ -0,0 +1,47 @@
+"""Reports residual entropy for each channel predictor in sample_log.txt.
+
+Each logged packet is re-predicted with every predictor in app/src/channel.c (same warm-up and
+clamping rules), and the zeroth-order entropy of the residuals is printed in bits/sample. That
+is roughly the floor an entropy coder can reach, so lower is better.
+
+Usage: python predictor_entropy.py
+"""
+
+import math
+from collections import Counter
+
+import gen_rans_tables
+import packet
+
+
+def residuals(samples, pred):
+    history = []
+    for s in samples:
+        if history:
+            yield s - packet.predict(history, pred)
+        history.append(s)
+
+
+def entropy(values):
+    counts = Counter(values)
+    total = sum(counts.values())
+    return -sum(c / total * math.log2(c / total) for c in counts.values())
+
+
+def main():
+    log = gen_rans_tables.read_log()
+    header = "".join(f"{name:>10}" for name in packet.PREDICTOR_NAMES)
+    print(f"{'channel':>12} {'samples':>8}{header}   (bits/sample)")
+    for (ch, _), packets in sorted(log.items()):
+        row = []
+        count = 0
+        for pred in range(len(packet.PREDICTOR_NAMES)):
+            values = [r for samples in packets for r in residuals(samples, pred)]
+            count = len(values)
+            row.append(entropy(values))
+        cells = "".join(f"{h:>10.2f}" for h in row)
+        print(f"{packet.CHANNEL_NAMES[ch]:>12} {count:>8}{cells}")
+
+
+if __name__ == "__main__":
+    main()
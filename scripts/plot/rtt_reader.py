@@ -0,0 +1,153 @@
+"""Reads the binary packet stream from the firmware's RTT up-buffer 1 (see app/src/rtt.c).
+
+Each frame is COBS(seq:16 | packet record | crc:16) followed by 0x00. Frames are checked and
+reassembled into the ring's packet records, and once a second the frame and byte rates are
+printed along with any sequence gaps and CRC errors. After a gap, data records are held back
+until the next anchor, so what is written with --records always decodes with
+packet.parse_packets(); the firmware's own gap records are always kept.
+
+The source is a capture file (e.g. from JLinkRTTLogger -RTTChannel 1), - for stdin, or host:port
+for an RTT TCP server such as OpenOCD's `rtt server start 9091 1`.
+
+Usage: python rtt_reader.py SOURCE [--records FILE]
+"""
+
+import argparse
+import socket
+import struct
+import sys
+import time
+
+import packet
+
+
+def crc16_kermit(data, crc=0):
+    """CRC-16/KERMIT, the same as Zephyr's crc16_ccitt() seeded with 0."""
+    for byte in data:
+        e = (crc ^ byte) & 0xFF
+        f = (e ^ (e << 4)) & 0xFF
+        crc = (crc >> 8) ^ (f << 8) ^ (f << 3) ^ (f >> 4)
+    return crc & 0xFFFF
+
+
+def cobs_decode(data):
+    out = bytearray()
+    pos = 0
+    while pos < len(data):
+        code = data[pos]
+        if code == 0 or pos + code > len(data):
+            raise ValueError("bad COBS block")
+        out += data[pos + 1 : pos + code]
+        pos += code
+        if code < 0xFF and pos < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+class FrameReader:
+    """Splits a byte stream into frames and tracks sequence gaps and CRC errors."""
+
+    def __init__(self):
+        self.pending = bytearray()
+        self.next_seq = None
+        self.frames = 0
+        self.bytes = 0
+        self.gaps = 0
+        self.missing = 0
+        self.crc_errors = 0
+        self.synced = False
+
+    def feed(self, data):
+        """Yields the packet record of every good frame in data, in order."""
+        self.bytes += len(data)
+        self.pending += data
+        while True:
+            end = self.pending.find(0)
+            if end < 0:
+                return
+            raw = bytes(self.pending[:end])
+            del self.pending[: end + 1]
+            # Whatever came before the first delimiter may be the tail of a frame.
+            record = self.decode(raw, quiet=not self.synced)
+            self.synced = True
+            if record is not None:
+                yield record
+
+    def decode(self, raw, quiet=False):
+        try:
+            frame = cobs_decode(raw)
+            crc = int.from_bytes(frame[-2:], "little")
+            valid = len(frame) >= 4 and crc16_kermit(frame[:-2]) == crc
+        except ValueError:
+            valid = False
+        if not valid:
+            self.crc_errors += not quiet
+            return None
+
+        (seq,) = struct.unpack_from("<H", frame)
+        if self.next_seq is not None and seq != self.next_seq:
+            self.gaps += 1
+            self.missing += (seq - self.next_seq) & 0xFFFF
+        self.next_seq = (seq + 1) & 0xFFFF
+        self.frames += 1
+        return frame[2:-2]
+
+
+def open_source(source):
+    if source == "-":
+        return sys.stdin.buffer.read1
+    if ":" in source:
+        host, port = source.rsplit(":", 1)
+        sock = socket.create_connection((host, int(port)))
+        return lambda n: sock.recv(n)
+    f = open(source, "rb")
+    return f.read
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("source", help="capture file, - for stdin, or host:port")
+    parser.add_argument("--records", help="write decodable packet records to this file")
+    args = parser.parse_args()
+
+    read = open_source(args.source)
+    out = open(args.records, "wb") if args.records else None
+    reader = FrameReader()
+    decodable = False
+    gaps = 0
+
+    start = last = time.monotonic()
+    last_frames = last_bytes = 0
+    while True:
+        data = read(4096)
+        if not data:
+            break
+        for record in reader.feed(data):
+            if reader.gaps != gaps:
+                gaps = reader.gaps
+                decodable = False
+            (header,) = struct.unpack_from("<H", record)
+            decodable = decodable or header >> 14 == packet.PACKET_ANCHOR
+            if out and (decodable or header >> 14 == packet.PACKET_GAP):
+                out.write(record)
+
+        now = time.monotonic()
+        if now - last >= 1.0:
+            print(
+                f"{(reader.frames - last_frames) / (now - last):8.1f} frames/s "
+                f"{(reader.bytes - last_bytes) / (now - last):9.0f} B/s "
+                f"gaps={reader.gaps} missing={reader.missing} crc_errors={reader.crc_errors}"
+            )
+            last, last_frames, last_bytes = now, reader.frames, reader.bytes
+
+    elapsed = max(time.monotonic() - start, 1e-9)
+    print(
+        f"total: frames={reader.frames} bytes={reader.bytes} ({reader.frames / elapsed:.1f} "
+        f"frames/s) gaps={reader.gaps} missing={reader.missing} crc_errors={reader.crc_errors}"
+    )
+    if out:
+        out.close()
+
+
+if __name__ == "__main__":
+    main()